@@ -0,0 +1,159 @@
+/**
+ * animation.h
+ *
+ * Short transitions of scene node properties.
+ *
+ * OVERVIEW:
+ * Animations smooth out changes that would otherwise happen from one frame to
+ * the next:
+ * - Opening a window fades its content in
+ * - Closing a window fades out a snapshot of its last frame (see snapshot.h)
+ * - Tiled windows given a new place by the layout slide there
+ * - Switching workspaces fades in the workspace being shown
+ * - Border colors fade when a window gains or loses focus
+ *
+ * Each animation interpolates one property of one scene node from where it
+ * is to a target over ANIMATION_DURATION_MS, with an ease-out curve. Starting
+ * an animation on a node that already runs one of the same kind retargets it
+ * from the node's current state, so nothing jumps.
+ *
+ * FRAME CLOCK:
+ * Animations are advanced from the output frame event, never from timers.
+ * Each frame computes every running animation's progress from the time
+ * elapsed since it started, so an animation runs at the output's refresh rate
+ * and ends on time even if frames are dropped. An output schedules its next
+ * frame only while something is still animating. Once every animation is
+ * done, no more frames are scheduled, and an idle desktop renders nothing.
+ *
+ * FRAME BUDGET:
+ * Every frame rendered while animating is timed. If ANIMATION_SLOW_FRAMES
+ * frames in a row take longer than ANIMATION_FRAME_BUDGET_MS to render, the
+ * machine can't keep up, so the running animations are jumped to their end
+ * and no new animations are started for the rest of the session. Changes
+ * are then applied immediately, as if ANIMATION_DURATION_MS were 0.
+ *
+ * LIFETIME:
+ * Each animation watches its node's destroy event and drops itself when the
+ * node goes away. Code that sets a property directly must first call
+ * animation_finish_node(), or the animation would overwrite it next frame.
+ */
+
+#ifndef ANIMATION_H
+#define ANIMATION_H
+
+#include <wayland-server-core.h>
+
+#include "server.h"
+
+struct tinywl_output;
+
+/**
+ * enum tinywl_animation_type - The property an animation interpolates
+ * @TINYWL_ANIMATION_FADE_IN: Opacity of every buffer below the node, 0 to 1
+ * @TINYWL_ANIMATION_FADE_OUT: Opacity of a snapshot, 1 to 0, then it is
+ *                             destroyed
+ * @TINYWL_ANIMATION_MOVE: Position of a window's scene node
+ * @TINYWL_ANIMATION_BORDER: Color of a window's borders
+ */
+enum tinywl_animation_type {
+  TINYWL_ANIMATION_FADE_IN,
+  TINYWL_ANIMATION_FADE_OUT,
+  TINYWL_ANIMATION_MOVE,
+  TINYWL_ANIMATION_BORDER,
+};
+
+/**
+ * struct tinywl_animation - A running animation
+ * @link: List node for server->animations
+ * @server: Back-pointer to the server
+ * @type: Property being interpolated
+ * @node: Node being animated
+ * @toplevel: Window whose node is animated, for moves and borders
+ * @snapshot: Snapshot being faded out, for fade outs
+ * @start_ns: CLOCK_MONOTONIC time the animation started at
+ * @from_x: Starting position, for moves
+ * @from_y: Starting position, for moves
+ * @to_x: Target position, for moves
+ * @to_y: Target position, for moves
+ * @from_color: Starting color, for borders
+ * @to_color: Target color, for borders
+ * @node_destroy: Listener dropping the animation with its node
+ */
+struct tinywl_animation {
+  struct wl_list link;
+  struct tinywl_server *server;
+  enum tinywl_animation_type type;
+  struct wlr_scene_node *node;
+  struct tinywl_toplevel *toplevel;
+  struct tinywl_snapshot *snapshot;
+  uint64_t start_ns;
+  int from_x, from_y, to_x, to_y;
+  float from_color[4], to_color[4];
+  struct wl_listener node_destroy;
+};
+
+/**
+ * animation_fade_in - Fades in every buffer below a node
+ * @server: Server state structure
+ * @node: An enabled node, such as a window's content or a workspace
+ */
+void animation_fade_in(struct tinywl_server *server,
+                       struct wlr_scene_node *node);
+
+/**
+ * animation_fade_out - Fades out a window that is being unmapped
+ * @toplevel: The window, called before its surfaces are gone
+ *
+ * A snapshot of the window's last frame takes its place in the scene and
+ * fades out. Does nothing if the window can't be seen.
+ */
+void animation_fade_out(struct tinywl_toplevel *toplevel);
+
+/**
+ * animation_move - Slides a window to a new position
+ * @toplevel: The window
+ * @x: Target X coordinate of the window's scene node
+ * @y: Target Y coordinate of the window's scene node
+ *
+ * The window's place in the spatial index follows it on every frame. The
+ * window is moved right away if animations are off.
+ */
+void animation_move(struct tinywl_toplevel *toplevel, int x, int y);
+
+/**
+ * animation_border_color - Fades a window's borders to a color
+ * @toplevel: The window
+ * @color: Target color, {red, green, blue, alpha}
+ *
+ * The color is set right away if animations are off.
+ */
+void animation_border_color(struct tinywl_toplevel *toplevel,
+                            const float color[4]);
+
+/**
+ * animation_finish_node - Jumps every animation of a node to its end
+ * @server: Server state structure
+ * @node: The node
+ */
+void animation_finish_node(struct tinywl_server *server,
+                           struct wlr_scene_node *node);
+
+/**
+ * animation_frame - Advances the running animations
+ * @output: Output about to render a frame
+ *
+ * Called from the output's frame event before rendering. Schedules the
+ * output's next frame if an animation is still running afterwards.
+ *
+ * Return: Whether anything was animated in this frame
+ */
+bool animation_frame(struct tinywl_output *output);
+
+/**
+ * animation_report_frame - Checks a frame's render time against the budget
+ * @server: Server state structure
+ * @render_ns: Time it took to render a frame that animation_frame() animated
+ */
+void animation_report_frame(struct tinywl_server *server, uint64_t render_ns);
+
+#endif
@@ -4,9 +4,10 @@
  * Keybinding configuration interface for the compositor.
  *
  * OVERVIEW:
- * Defines the keybinding system for Nocturne. Keybindings are divded into two
+ * Defines the keybinding system for Nocturne. Keybindings are divded into three
  * categories:
  * - Compositor bindings: Actions that control the compositor itself
+ * - Workspace bindings: Switching workspaces and moving windows between them
  * - User bindings: Launching external applications
  *
  * MODIFIER KEY:
@@ -20,6 +21,10 @@
  * KEYSYMS:
  * Keys are identified using xkb_keysym_t values from xkbcommon. These are
  * cross-platform symbolic represenatations of keys.
+ *
+ * WINDOW RULES:
+ * Window rules pick settings for windows by their app_id and title when they
+ * are mapped, see window_rule and rules.h.
  */
 
 #ifndef CONFIG_H
@@ -30,11 +35,20 @@
 #include "server.h"
 
 /* Number of compositor-level keybindings */
-#define C_BINDINGS_COUNT 3
+#define C_BINDINGS_COUNT 16
+
+/* Number of workspace keybindings */
+#define WS_BINDINGS_COUNT 18
 
 /* Number of user-level application keybindings */
 #define BINDINGS_COUNT 14
 
+/* Number of window rules */
+#define RULES_COUNT 3
+
+/* Number of workspaces on each output */
+#define WORKSPACE_COUNT 9
+
 /**
  * MODKEY - The modifier key required for all keybindings
  *
@@ -43,6 +57,168 @@
  */
 #define MODKEY WLR_MODIFIER_ALT
 
+/**
+ * LOG_RATE_LIMIT - Maximum number of log messages accepted per second
+ * LOG_RATE_BURST - Number of messages that may be logged back-to-back
+ *
+ * The log sink uses a token bucket that refills at LOG_RATE_LIMIT tokens per
+ * second and holds at most LOG_RATE_BURST tokens. Messages logged without a
+ * token are dropped before being formatted. Errors are never rate limited.
+ */
+#define LOG_RATE_LIMIT 500
+#define LOG_RATE_BURST 1000
+
+/**
+ * BORDER_WIDTH - Width of the borders drawn around windows, in pixels
+ * BORDER_COLOR_FOCUSED - Border color of the window with keyboard focus
+ * BORDER_COLOR_UNFOCUSED - Border color of every other window
+ *
+ * Colors are {red, green, blue, alpha} with components from 0 to 1. They are
+ * only applied when a window gains or loses focus, never per frame.
+ */
+#define BORDER_WIDTH 2
+#define BORDER_COLOR_FOCUSED {1.0f, 0.647f, 0.0f, 1.0f}
+#define BORDER_COLOR_UNFOCUSED {0.3f, 0.3f, 0.3f, 1.0f}
+
+/**
+ * TAB_HEIGHT - Height of a tab or of a stacked title row, in pixels
+ * TAB_COLOR_ACTIVE - Color of the tab of the child being shown
+ * TAB_COLOR_INACTIVE - Color of the other tabs
+ *
+ * See layout.h.
+ */
+#define TAB_HEIGHT 8
+#define TAB_COLOR_ACTIVE {1.0f, 0.647f, 0.0f, 1.0f}
+#define TAB_COLOR_INACTIVE {0.3f, 0.3f, 0.3f, 1.0f}
+
+/**
+ * SNAP_THRESHOLD - Distance at which dragged windows snap to edges, in pixels
+ *
+ * See snap.h. Setting this to 0 only snaps edges that already line up.
+ */
+#define SNAP_THRESHOLD 12
+
+/**
+ * FOCUS_FOLLOWS_MOUSE - Whether the window under the pointer gets focus
+ * FOCUS_DWELL_MS - Time the pointer must rest on a window before it does
+ *
+ * See cursor.h. Sweeping the pointer across windows faster than the dwell
+ * time doesn't focus any of them. Set FOCUS_FOLLOWS_MOUSE to 0 to focus on
+ * click only.
+ */
+#define FOCUS_FOLLOWS_MOUSE 1
+#define FOCUS_DWELL_MS 150
+
+/**
+ * UNFOCUSED_FRAME_RATE - Highest frame rate of unfocused windows, in Hz
+ *
+ * Visible windows that don't have keyboard focus receive frame callbacks at
+ * most this often, which slows down background animations, spinners and
+ * video without hiding them. The focused window, windows being resized and
+ * windows waiting on a layout change always run at the output's refresh
+ * rate. Setting this to 0 disables throttling.
+ */
+#define UNFOCUSED_FRAME_RATE 30
+
+/**
+ * THUMBNAIL_SIZE - Largest side of a window thumbnail, in pixels
+ * THUMBNAIL_CACHE_SIZE - Memory kept for cached thumbnails, in bytes
+ *
+ * See thumbnail.h. Thumbnails take 4 bytes per pixel, so the default fits
+ * around a hundred 192x108 thumbnails.
+ */
+#define THUMBNAIL_SIZE 192
+#define THUMBNAIL_CACHE_SIZE (8 * 1024 * 1024)
+
+/**
+ * SWITCHER_PADDING - Space around each thumbnail in the switcher, in pixels
+ * SWITCHER_BACKGROUND_COLOR - Color behind the switcher's thumbnails
+ */
+#define SWITCHER_PADDING 12
+#define SWITCHER_BACKGROUND_COLOR {0.1f, 0.1f, 0.1f, 0.9f}
+
+/**
+ * OVERVIEW_DURATION_MS - Length of the overview's zoom animation
+ * OVERVIEW_GAP - Space between the overview's grid cells, in pixels
+ * OVERVIEW_BACKGROUND_COLOR - Color dimming the output behind the overview
+ */
+#define OVERVIEW_DURATION_MS 200
+#define OVERVIEW_GAP 24
+#define OVERVIEW_BACKGROUND_COLOR {0.05f, 0.05f, 0.05f, 0.85f}
+
+/**
+ * ANIMATION_DURATION_MS - Length of window and workspace animations
+ * ANIMATION_FRAME_BUDGET_MS - Longest acceptable render time of a frame
+ * ANIMATION_SLOW_FRAMES - Slow frames in a row that turn animations off
+ *
+ * See animation.h. Setting ANIMATION_DURATION_MS to 0 disables animations.
+ */
+#define ANIMATION_DURATION_MS 150
+#define ANIMATION_FRAME_BUDGET_MS 8
+#define ANIMATION_SLOW_FRAMES 3
+
+/**
+ * SERVER_SIDE_DECORATIONS - Whether windows are asked not to decorate
+ *                           themselves
+ *
+ * See decoration.h. With 0, windows pick their own mode. Either way the
+ * client_decorations window rule decides for the windows it matches.
+ */
+#define SERVER_SIDE_DECORATIONS 1
+
+/**
+ * SESSION_RESTORE - Whether the window arrangement is kept across sessions
+ * SESSION_FILE - Where it is kept, relative to $XDG_STATE_HOME
+ * SESSION_RESTORE_TIMEOUT_MS - Time windows have to claim their old place
+ *
+ * See session.h. $XDG_STATE_HOME defaults to ~/.local/state. Places no
+ * window claimed within the timeout are given up.
+ */
+#define SESSION_RESTORE 1
+#define SESSION_FILE "nocturne/session"
+#define SESSION_RESTORE_TIMEOUT_MS 10000
+
+/**
+ * enum rule_flag - A yes or no setting of a window rule
+ * @RULE_UNSET: The rule leaves the setting alone
+ * @RULE_YES: The rule turns the setting on
+ * @RULE_NO: The rule turns the setting off
+ */
+enum rule_flag {
+  RULE_UNSET,
+  RULE_YES,
+  RULE_NO,
+};
+
+/**
+ * window_rule - Settings applied to matching windows when they are mapped
+ * @app_id: app_id the window must have, NULL matches any window
+ * @title: POSIX extended regular expression the title must match, NULL
+ *         matches any title
+ * @floating: Whether the window floats instead of being tiled
+ * @workspace: Workspace to open the window on, from 1, 0 for the shown one
+ * @width: Initial width of a floating window, 0 to let the client pick
+ * @height: Initial height of a floating window, 0 to let the client pick
+ * @border: Whether the window has borders
+ * @throttle: Whether frame callbacks are throttled while the window is
+ *            unfocused, see UNFOCUSED_FRAME_RATE
+ * @client_decorations: Whether the window draws its own titlebar and shadows,
+ *                      see SERVER_SIDE_DECORATIONS
+ *
+ * Matching app_ids are looked up in a hash table, see rules.h. Rules without
+ * an app_id are tried for every window, so prefer giving one.
+ */
+typedef struct {
+  const char *app_id;
+  const char *title;
+  enum rule_flag floating;
+  int workspace;
+  int width, height;
+  enum rule_flag border;
+  enum rule_flag throttle;
+  enum rule_flag client_decorations;
+} window_rule;
+
 /**
  * compositor_binding - Binds a key to a compositor function
  * @key: The xkb keysym that triggers this binding
@@ -61,6 +237,21 @@ typedef struct {
   void (*fptr)(struct tinywl_server *server);
 } compositor_binding;
 
+/**
+ * workspace_binding - Binds a key to a workspace action
+ * @key: The xkb keysym that triggers this binding
+ * @fptr: Function pointer to the workspace action to execute
+ * @index: Workspace passed to the action, starting at 0
+ *
+ * Used for switching workspaces and sending the focused window to another
+ * workspace.
+ */
+typedef struct {
+  xkb_keysym_t key;
+  void (*fptr)(struct tinywl_server *server, int index);
+  int index;
+} workspace_binding;
+
 /**
  * user_binding - Binds a key to a shell command
  * @key: The xkb keysym that triggers this binding
@@ -83,6 +274,20 @@ typedef struct {
  */
 const compositor_binding *get_c_bindings(void);
 
+/**
+ * get_rules - Returns array of window rules
+ *
+ * Return: Pointer to static array of window_rule structs
+ */
+const window_rule *get_rules(void);
+
+/**
+ * get_ws_bindings - Returns array of workspace keybindings
+ *
+ * Return: Pointer to static array of workspace_binding structs
+ */
+const workspace_binding *get_ws_bindings(void);
+
 /**
  * get_bindings - Returns array of user keybindings
  *
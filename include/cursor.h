@@ -27,13 +27,86 @@
  * - Cursor motion events are intercepted by the compositor
  * - process_cursor_move() or process_cursor_resize() handles the motion
  * - On button release, reset_cursor_mode() returns to normal
+ *
+ * MOVE BATCHING:
+ * Only the window's position at render time is visible, so pointer motion
+ * during a move just records the target position. The target is applied once
+ * per output frame by cursor_apply_move(), no matter how many motion events
+ * arrived in between. The target is snapped to nearby edges, see snap.h.
+ *
+ * RESIZE THROTTLING:
+ * Pointers can report motion a thousand times per second, far more often
+ * than most clients can redraw. Every configure sent to a client has to be
+ * answered with a new buffer, so a client flooded with configures falls
+ * behind and the window lags further and further behind the pointer.
+ *
+ * A resized window therefore has at most one configure outstanding. Motion
+ * that arrives in the meantime only replaces the queued size, and the newest
+ * size is sent once the client has acked and committed the previous one.
+ *
+ * RESIZE SNAPSHOTS:
+ * While the client is catching up, the window shows a snapshot of its last
+ * frame (see snapshot.h) stretched to the newest size, and the live content
+ * is hidden. The window thus tracks the pointer every frame however slow the
+ * client is, and never shows a frame drawn at the wrong size. Each time the
+ * client answers a configure, the snapshot is retaken from its new frame.
+ * Once the client has drawn the newest size, the snapshot is dropped and the
+ * window is placed to match the size the client actually picked, keeping the
+ * edges that aren't dragged in place.
+ *
+ * The hidden content still gets a frame callback every output frame, clients
+ * that wait for one before drawing would never answer the configure
+ * otherwise. A client that doesn't answer within TRANSACTION_TIMEOUT_MS is
+ * shown live again, and releasing the button always shows the live window
+ * and sends it the final size.
+ *
+ * FOCUS FOLLOWS MOUSE:
+ * With FOCUS_FOLLOWS_MOUSE set, the window under the pointer gets keyboard
+ * focus once the pointer has rested on it for FOCUS_DWELL_MS. Motion only
+ * records which window is under the pointer and since when, and rearms a
+ * timer whenever that window changes. The decision is taken once per output
+ * frame by cursor_focus_frame(), the timer merely schedules that frame in
+ * case nothing else would. Sweeping the pointer across ten windows therefore
+ * keeps rearming the timer, and none of them is raised or focused. The
+ * desktop never takes focus away, and a window focused from the keyboard
+ * keeps focus until the pointer moves to another window. Nothing is decided
+ * while the seat has a pointer or keyboard grab, such as an open menu's.
+ *
+ * REDUNDANT WORK:
+ * Pointer motion arrives up to a thousand times per second, and usually
+ * stays on the same surface. Entering a surface is only announced to the
+ * seat when the pointer moves onto another one, and the default cursor image
+ * is only set again when a client changed it in the meantime.
  */
 
 #ifndef CURSOR_H
 #define CURSOR_H
 
+#include <time.h>
+
 #include "server.h"
 
+struct tinywl_output;
+
+/**
+ * cursor_focus_frame - Focuses the window the pointer rests on
+ * @server: Server state structure
+ *
+ * Called from each output frame. Does nothing unless the pointer entered a
+ * window at least FOCUS_DWELL_MS ago and that window wasn't decided on yet.
+ */
+void cursor_focus_frame(struct tinywl_server *server);
+
+/**
+ * cursor_focus_timeout - Schedules a frame to take the focus decision
+ * @data: Server state structure
+ *
+ * Timer callback armed by pointer motion, see FOCUS FOLLOWS MOUSE above.
+ *
+ * Return: Always 0
+ */
+int cursor_focus_timeout(void *data);
+
 /**
  * reset_cursor_mode - Returns cursor to passthrough mode
  * @server: Server state structure
@@ -42,9 +115,14 @@
  * normal cursor behavior where pointer events are sent to clients instead of
  * being consumed by the compositor.
  *
+ * A pending move is applied first, so the window ends up exactly where the
+ * pointer left it. A resized window is shown live again and sent the last
+ * size queued.
+ *
  * Clears:
  * - cursor_mode: Set back to TINYWL_CURSOR_PASSTHROUGH
  * - grabbed_toplevel: Cleared to NULL
+ * - snap_index: The edges collected for the move
  */
 void reset_cursor_mode(struct tinywl_server *server);
 
@@ -57,10 +135,21 @@ void reset_cursor_mode(struct tinywl_server *server);
  * - Current cursor position
  * - Initial grab offset (where on the window the user grabbed)
  *
- * The window follows the cursor maintaining the same grab point.
+ * The window follows the cursor maintaining the same grab point, snapped to
+ * nearby edges. The position is recorded and a frame is scheduled, the window
+ * is moved by cursor_apply_move() when the frame is rendered.
  */
 void process_cursor_move(struct tinywl_server *server);
 
+/**
+ * cursor_apply_move - Moves the grabbed window to its latest target
+ * @server: Server state structure
+ *
+ * Called before rendering each output frame, and when the move ends. Does
+ * nothing if the pointer didn't move since the last call.
+ */
+void cursor_apply_move(struct tinywl_server *server);
+
 /**
  * process_cursor_resize - Handles cursor motion during window resize
  * @server: Server state structure
@@ -71,10 +160,43 @@ void process_cursor_move(struct tinywl_server *server);
  * - May need to move the window (resizing from top/left)
  * - Must respect minimum size
  *
- * Uses server->resize_edges to know which edges are being dragged.
+ * Uses server->resize_edges to know which edges are being dragged. The new
+ * size is queued, see RESIZE THROTTLING above.
  */
 void process_cursor_resize(struct tinywl_server *server);
 
+/**
+ * cursor_resize_notify_commit - Applies a commit to an interactive resize
+ * @toplevel: The window that committed
+ *
+ * Called on every commit of a window. Once the client committed in response
+ * to the outstanding resize configure, the queued size is sent, if any.
+ * Otherwise the snapshot is removed and the window is moved to match its new
+ * size.
+ */
+void cursor_resize_notify_commit(struct tinywl_toplevel *toplevel);
+
+/**
+ * cursor_resize_frame - Sends frame callbacks to a window hidden by a resize
+ * @output: Output that just rendered a frame
+ * @when: Time of the frame
+ *
+ * Called from every output frame, see RESIZE SNAPSHOTS above.
+ */
+void cursor_resize_frame(struct tinywl_output *output,
+                         const struct timespec *when);
+
+/**
+ * cursor_resize_timeout - Shows a resized window that didn't catch up
+ * @data: Server state structure
+ *
+ * Timer callback armed with each resize configure, the snapshot is dropped
+ * and the next motion sends the queued size.
+ *
+ * Return: Always 0
+ */
+int cursor_resize_timeout(void *data);
+
 /**
  * process_cursor_motion - Main cursor motion handler
  * @server: Server state structure
@@ -180,6 +302,9 @@ void server_cursor_frame(struct wl_listener *listener, void *data);
  *
  * After calling this, pointer events are consumed by process_cursor_move() or
  * process_cursor_resize() instead of being sent to clients.
+ *
+ * Tiled windows are placed by the tiling layout, so requests to move or
+ * resize them are ignored.
  */
 void begin_interactive(struct tinywl_toplevel *toplevel,
                        enum tinywl_cursor_mode mode, uint32_t edges);
@@ -0,0 +1,64 @@
+/**
+ * decoration.h
+ *
+ * Server-side decoration negotiation.
+ *
+ * OVERVIEW:
+ * The xdg-decoration protocol lets a window agree with the compositor on who
+ * draws its decorations. Nocturne draws its own borders around every window
+ * (see toplevel.h), so by default it asks every window to leave decorations
+ * to the server. Toolkits like GTK and Qt then drop their client-side
+ * titlebars and shadows:
+ * - Buffers shrink to the content area, so there is less to render, upload
+ *   and composite
+ * - The window geometry starts at the buffer's origin, tiles and borders
+ *   line up with what the client drew
+ *
+ * MODE:
+ * SERVER_SIDE_DECORATIONS in config.h picks the mode for every window. The
+ * client_decorations window rule overrides it per app_id and title, see
+ * rules.h. The mode is decided when the window makes its initial commit,
+ * the first time its app_id is known, and it goes out with the initial
+ * configure, so the client never draws a decorated frame first. A window
+ * asking for another mode later is told the same mode again.
+ *
+ * Windows that decorate themselves because of a rule lose Nocturne's borders
+ * too, unless a rule gives them borders. Clients that don't implement the
+ * protocol keep decorating themselves.
+ */
+
+#ifndef DECORATION_H
+#define DECORATION_H
+
+#include <wayland-server-core.h>
+#include <wlr/types/wlr_xdg_decoration_v1.h>
+
+#include "server.h"
+
+struct tinywl_toplevel;
+
+/**
+ * server_new_toplevel_decoration - Handles a window's decoration object
+ * @listener: Wayland listener that triggered this callback
+ * @data: Pointer to wlr_xdg_toplevel_decoration_v1
+ *
+ * Ties the decoration to its window and sends the mode right away if the
+ * window already made its initial commit.
+ */
+void server_new_toplevel_decoration(struct wl_listener *listener, void *data);
+
+/**
+ * decoration_update - Sends a window the decoration mode picked for it
+ * @toplevel: The window, during its initial commit
+ *
+ * Does nothing for windows without a decoration object.
+ */
+void decoration_update(struct tinywl_toplevel *toplevel);
+
+/**
+ * decoration_finish - Detaches a window's decoration object
+ * @toplevel: The window, being destroyed
+ */
+void decoration_finish(struct tinywl_toplevel *toplevel);
+
+#endif
@@ -0,0 +1,298 @@
+/**
+ * layout.h
+ *
+ * Dynamic tiling layout engine.
+ *
+ * OVERVIEW:
+ * Tiled windows are arranged by a tree of containers, one tree per workspace.
+ * This is the same model Sway and i3 use:
+ * - The root container covers the workspace's whole output
+ * - Split containers divide their area between their children, either side
+ *   by side (horizontal split) or on top of each other (vertical split)
+ * - Leaf containers hold exactly one toplevel
+ *
+ * INSERTION:
+ * A new window is placed next to the most recently focused tiled window on
+ * the same workspace. If the focused window is wider than it is tall, the
+ * space is split horizontally, otherwise vertically. When the focused window's
+ * parent already splits in that direction, the new window simply becomes its
+ * sibling. Otherwise the focused leaf is replaced by a new split container
+ * holding both windows.
+ *
+ * INCREMENTAL ARRANGEMENT:
+ * Every container remembers the box it was last given. Arranging starts at
+ * the container whose children changed and recurses only into children whose
+ * box actually changed. Mapping a window only touches its parent's subtree,
+ * and a toplevel only gets a configure event when its size changes, so
+ * rearranging is a cheap walk over a handful of nodes no matter how many
+ * windows are open elsewhere.
+ *
+ * TABBED AND STACKED:
+ * A container can also show one child at a time. A tabbed container draws a
+ * row of TAB_HEIGHT tabs, one per child, and a stacked container draws one
+ * such row per child above each other. Either way, every child is given the
+ * whole area below the bar, and only the active child's windows have their
+ * scene nodes enabled. The windows in the other children aren't rendered,
+ * get no frame callbacks, and are suspended like any window that can't be
+ * seen, see occlusion.h. Grouping many windows this way costs no more than
+ * showing one.
+ *
+ * Since all children already have the right size, switching tabs is only a
+ * matter of enabling one subtree and disabling another, which shows up in
+ * the next frame without any client being configured. Focusing a window in a
+ * hidden child, from the keyboard or by clicking its tab, switches to it.
+ *
+ * WEIGHTS:
+ * Each child of a split has a weight, and the split's area is divided in
+ * proportion to the weights. Growing or shrinking the focused window adjusts
+ * its weight and rearranges its parent only.
+ *
+ * SAVED TREES:
+ * When an output goes away, the shape of each workspace's tree is saved:
+ * splits, directions, weights, and which window each leaf held. Each window
+ * points back to its saved leaf. When the output comes back, the saved tree
+ * is grafted onto the new workspace in one step, leaves whose window was
+ * closed or stopped tiling in the meantime are dropped, and the tree is
+ * arranged once. See output.h.
+ *
+ * PLACEHOLDERS:
+ * A leaf can also wait for a window that doesn't exist yet. A placeholder
+ * holds the app_id of the window expected there and takes its share of the
+ * area like any leaf, so the windows around it are already at their final
+ * size when it is filled. Filling a placeholder doesn't rearrange anything
+ * but the placeholder itself. See session.h.
+ */
+
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+#include <wayland-server-core.h>
+
+#include "server.h"
+
+/**
+ * enum tinywl_container_layout - How a split container arranges children
+ * @TINYWL_LAYOUT_SPLIT_H: Children are placed side by side
+ * @TINYWL_LAYOUT_SPLIT_V: Children are stacked top to bottom
+ * @TINYWL_LAYOUT_TABBED: Only the active child is shown, below a row of tabs
+ * @TINYWL_LAYOUT_STACKED: Only the active child is shown, below one title row
+ *                         per child
+ */
+enum tinywl_container_layout {
+  TINYWL_LAYOUT_SPLIT_H,
+  TINYWL_LAYOUT_SPLIT_V,
+  TINYWL_LAYOUT_TABBED,
+  TINYWL_LAYOUT_STACKED,
+};
+
+/**
+ * struct tinywl_container - A node in the tiling tree
+ * @parent: Parent split container, NULL for the root
+ * @link: List node for parent->children
+ * @children: Child containers (split containers only)
+ * @toplevel: The window held by this container (leaves only)
+ * @workspace: Workspace this tree belongs to (root only)
+ * @layout: Split direction (split containers only)
+ * @weight: Share of the parent's area relative to the siblings
+ * @box: Area last assigned to this container, in layout coordinates
+ * @active: Child that is shown (tabbed and stacked containers)
+ * @tab_tree: Scene tree holding the tab bar (tabbed and stacked containers)
+ * @placeholder: app_id of the window expected in this leaf (placeholders only)
+ *
+ * A container is a leaf when toplevel is non-NULL and a split otherwise. A
+ * placeholder has neither a window nor children.
+ */
+struct tinywl_container {
+  struct tinywl_container *parent;
+  struct wl_list link;
+  struct wl_list children;
+
+  struct tinywl_toplevel *toplevel;
+  struct tinywl_workspace *workspace;
+
+  enum tinywl_container_layout layout;
+  double weight;
+  struct wlr_box box;
+
+  struct tinywl_container *active;
+  struct wlr_scene_tree *tab_tree;
+  char *placeholder;
+};
+
+/**
+ * layout_root_create - Creates the root container of a workspace
+ * @workspace: The workspace that the tree will tile
+ *
+ * Return: The new, empty root container
+ */
+struct tinywl_container *layout_root_create(struct tinywl_workspace *workspace);
+
+/**
+ * layout_root_destroy - Destroys a workspace's tiling tree
+ * @root: Root container to destroy, its windows must have been moved away
+ */
+void layout_root_destroy(struct tinywl_container *root);
+
+/**
+ * layout_set_root_box - Updates the area a tiling tree covers
+ * @root: Root container
+ * @box: New area in layout coordinates
+ *
+ * Called when the workspace's output changes position or size. Only windows
+ * whose tile changes as a result are reconfigured.
+ */
+void layout_set_root_box(struct tinywl_container *root,
+                         const struct wlr_box *box);
+
+/**
+ * layout_insert - Tiles a window
+ * @root: Tree to insert the window into
+ * @toplevel: The window to tile
+ *
+ * Inserts the window next to the most recently focused tiled window of the
+ * tree and rearranges only the split container that gained a child.
+ */
+void layout_insert(struct tinywl_container *root,
+                   struct tinywl_toplevel *toplevel);
+
+/**
+ * layout_remove - Removes a window from its tiling tree
+ * @toplevel: A tiled window
+ *
+ * Split containers left with a single child are collapsed into their parent
+ * so the tree stays shallow.
+ */
+void layout_remove(struct tinywl_toplevel *toplevel);
+
+/**
+ * layout_resize - Grows or shrinks a tiled window within its split
+ * @toplevel: A tiled window
+ * @delta: Amount to add to the window's weight
+ */
+void layout_resize(struct tinywl_toplevel *toplevel, double delta);
+
+/**
+ * layout_save - Copies the shape of a tiling tree
+ * @root: Root container
+ *
+ * Windows that already belong to another saved output are left out. Each window in
+ * the copy gets its home_leaf set to its leaf in the copy.
+ *
+ * Return: A detached tree holding the same windows as root
+ */
+struct tinywl_container *layout_save(struct tinywl_container *root);
+
+/**
+ * layout_restore - Grafts a saved tree onto an empty tiling tree
+ * @root: Empty root container
+ * @saved: Tree returned by layout_save(), consumed
+ *
+ * Every window still pointing to its leaf in saved must have been taken off
+ * its current tree. Leaves that were given up with layout_forget_leaf() are
+ * dropped and the splits left with too few children are collapsed.
+ */
+void layout_restore(struct tinywl_container *root,
+                    struct tinywl_container *saved);
+
+/**
+ * layout_forget_leaf - Gives up a window's place in a saved tree
+ * @toplevel: A window, does nothing if it has no saved leaf
+ */
+void layout_forget_leaf(struct tinywl_toplevel *toplevel);
+
+/**
+ * layout_saved_destroy - Frees a saved tree that won't be restored
+ * @saved: Tree returned by layout_save(), may be NULL
+ */
+void layout_saved_destroy(struct tinywl_container *saved);
+
+/**
+ * layout_saved_add - Adds a container to a detached tree
+ * @parent: Split to append the container to, NULL to start a new tree
+ * @layout: Split direction of the container
+ * @weight: Share of the parent's area
+ * @placeholder: app_id of the window expected in the leaf, NULL for a split
+ *
+ * Builds a tree like the ones returned by layout_save(), to be grafted with
+ * layout_restore(). Placeholders are kept when it is restored.
+ *
+ * Return: The new container
+ */
+struct tinywl_container *layout_saved_add(struct tinywl_container *parent,
+                                          enum tinywl_container_layout layout,
+                                          double weight,
+                                          const char *placeholder);
+
+/**
+ * layout_fill_placeholder - Tiles a window in a placeholder
+ * @placeholder: A placeholder leaf of a workspace's tree
+ * @toplevel: The window, not tiled anywhere
+ *
+ * The placeholder becomes the window's leaf. Only the window itself is
+ * given a tile, the rest of the tree already made room for it.
+ */
+void layout_fill_placeholder(struct tinywl_container *placeholder,
+                             struct tinywl_toplevel *toplevel);
+
+/**
+ * layout_remove_placeholder - Drops a placeholder that won't be filled
+ * @placeholder: A placeholder leaf of a workspace's tree
+ *
+ * Its space goes to its siblings, as if a window was removed.
+ */
+void layout_remove_placeholder(struct tinywl_container *placeholder);
+
+/**
+ * layout_show_toplevel - Switches tabs to show a window
+ * @toplevel: A tiled window
+ *
+ * Every tabbed or stacked container above the window makes the child holding
+ * it active. Called whenever a window is focused.
+ */
+void layout_show_toplevel(struct tinywl_toplevel *toplevel);
+
+/**
+ * layout_tab_at - Finds the tab under a point
+ * @server: Server state structure
+ * @lx: X coordinate in layout space
+ * @ly: Y coordinate in layout space
+ *
+ * Return: The most recently focused window of the tab or title row under the
+ * point, or NULL if the point isn't over one
+ */
+struct tinywl_toplevel *layout_tab_at(struct tinywl_server *server, double lx,
+                                      double ly);
+
+/**
+ * tab_focused_container - Makes the focused window's container tabbed
+ * @server: Server state structure
+ */
+void tab_focused_container(struct tinywl_server *server);
+
+/**
+ * stack_focused_container - Makes the focused window's container stacked
+ * @server: Server state structure
+ */
+void stack_focused_container(struct tinywl_server *server);
+
+/**
+ * split_focused_container - Splits the focused window's container again
+ * @server: Server state structure
+ *
+ * The direction follows the container's shape, as for new splits.
+ */
+void split_focused_container(struct tinywl_server *server);
+
+/**
+ * grow_focused_toplevel - Gives the focused tiled window more space
+ * @server: Server state structure
+ */
+void grow_focused_toplevel(struct tinywl_server *server);
+
+/**
+ * shrink_focused_toplevel - Gives the focused tiled window less space
+ * @server: Server state structure
+ */
+void shrink_focused_toplevel(struct tinywl_server *server);
+
+#endif
@@ -0,0 +1,74 @@
+/**
+ * log.h
+ *
+ * Level-filtered, non-blocking log sink for wlroots and compositor messages.
+ *
+ * OVERVIEW:
+ * wlroots routes every wlr_log() call through a single callback. By default
+ * that callback formats the message and writes it to stderr right away, on the
+ * compositor thread. If stderr is a slow terminal, a pipe into journald, or a
+ * file on a busy disk, that write() blocks the event loop and frames are
+ * missed.
+ *
+ * Nocturne installs its own callback instead. The compositor thread only
+ * formats the message into a slot of a fixed-size ring buffer, and a
+ * background thread drains the ring and performs the actual writes.
+ *
+ * LOG LEVEL:
+ * The verbosity is chosen at runtime with the -l command-line option. wlroots
+ * checks the verbosity before calling our callback, so filtered messages cost
+ * a single comparison and are never formatted.
+ *
+ * RING BUFFER:
+ * The ring is a bounded lock-free queue. Each slot carries a sequence number
+ * that tells producers whether it is free and the consumer whether it is
+ * filled, so no mutex is ever taken on the logging path. If the ring is full
+ * the message is dropped and counted instead of waiting for the writer.
+ *
+ * RATE LIMITING:
+ * A token bucket caps how many messages per second are accepted (see
+ * LOG_RATE_LIMIT in config.h). A flood of debug lines, such as one per pointer
+ * motion event, is cut off before it is even formatted. Errors bypass the
+ * bucket so they are never lost to a flood of less important messages.
+ *
+ * The writer thread reports how many messages were dropped, so gaps in the
+ * log are visible instead of silent.
+ */
+
+#ifndef LOG_H
+#define LOG_H
+
+#include <stdbool.h>
+#include <wlr/util/log.h>
+
+/**
+ * log_level_from_name - Parses a log level name
+ * @name: One of "silent", "error", "info" or "debug"
+ * @level: Output parameter for the parsed level
+ *
+ * Return: true if the name was recognized, false otherwise
+ */
+bool log_level_from_name(const char *name, enum wlr_log_importance *level);
+
+/**
+ * log_init - Starts the background log writer and installs the sink
+ * @level: Most verbose level that should be logged
+ *
+ * Spawns the writer thread and registers our callback with wlr_log_init().
+ * If the thread can't be created, logging falls back to the synchronous
+ * wlroots default so that messages are never lost entirely.
+ *
+ * Return: true if the asynchronous sink is active, false on fallback
+ */
+bool log_init(enum wlr_log_importance level);
+
+/**
+ * log_finish - Flushes pending messages and stops the writer thread
+ *
+ * Called on shutdown after everything else has been cleaned up. Any messages
+ * still in the ring are written before the thread exits. Logging after this
+ * call goes to stderr synchronously through the wlroots default handler.
+ */
+void log_finish(void);
+
+#endif
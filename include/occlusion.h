@@ -0,0 +1,63 @@
+/**
+ * occlusion.h
+ *
+ * Suspending windows that can't be seen.
+ *
+ * OVERVIEW:
+ * xdg-shell (version 6 and up) has a "suspended" toplevel state. It tells a
+ * client that none of its window is visible, so it can stop animating,
+ * decoding video, or running its render loop. Browsers and Electron apps are
+ * the main beneficiaries, they otherwise keep drawing in the background.
+ *
+ * A window is suspended when it is:
+ * - On a workspace that isn't shown
+ * - Outside of every output
+ * - Fully covered by the opaque regions of windows stacked above it
+ *
+ * COMPUTATION:
+ * Occlusion is recomputed from the scene whenever windows move, change
+ * stacking order, or a workspace is switched. The work is deferred to an idle
+ * callback, so a burst of changes in one event loop iteration results in a
+ * single pass. The pass walks the shown workspace of every output from the
+ * topmost floating window down to the bottom tiled window, accumulating the
+ * area covered so far in a pixman region. A window is visible if any part of
+ * it is on an output and not yet covered.
+ *
+ * Only a window's main surface opaque region counts as covering. Clients that
+ * don't declare an opaque region never hide what is below them, so mistakes
+ * err towards rendering too much rather than too little.
+ *
+ * TRANSACTIONS:
+ * Windows waiting for a transaction are never suspended. They must draw a new
+ * frame at their new size before the layout can be applied.
+ *
+ * Tiled windows sliding to a new place are judged by where they are when a
+ * pass runs, so the pass is run again once a slide ends, see animation.h.
+ *
+ * Clients that bound xdg_wm_base below version 6 don't know the suspended
+ * state and are skipped.
+ */
+
+#ifndef OCCLUSION_H
+#define OCCLUSION_H
+
+#include <wayland-server-core.h>
+
+#include "server.h"
+
+/**
+ * occlusion_schedule - Requests recomputing which windows are visible
+ * @server: Server state structure
+ *
+ * Cheap to call any number of times, the computation runs once when the
+ * event loop goes idle.
+ */
+void occlusion_schedule(struct tinywl_server *server);
+
+/**
+ * occlusion_finish - Cancels a pending occlusion pass
+ * @server: Server state structure
+ */
+void occlusion_finish(struct tinywl_server *server);
+
+#endif
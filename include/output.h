@@ -39,6 +39,34 @@
  * - Render the scene graph to the output
  * - Commit the output state (send it to the display)
  * - Send frame_done events to clients (so they know to draw next frame)
+ *
+ * FRAME THROTTLING:
+ * Clients draw their next frame when they get frame_done, so the rate of
+ * frame_done events is the rate at which they render. Only the focused
+ * window gets one on every frame. Other visible windows get them at most
+ * UNFOCUSED_FRAME_RATE times per second (see config.h), with half an output
+ * frame of slack so a 30 Hz limit on a 60 Hz output really is every other
+ * frame. Windows being resized or waiting on a transaction are exempt, they
+ * must catch up with the compositor as fast as possible.
+ *
+ * A held back callback is owed a frame: a timer schedules one for when the
+ * earliest of them is due, so a window animating on an otherwise idle output
+ * keeps drawing at the reduced rate.
+ *
+ * HOTPLUG:
+ * When an output goes away, its layout is saved under the output's name
+ * (e.g. "DP-1"): the shape of each workspace's tiling tree (see layout.h),
+ * where each floating window was relative to the output, and which workspace
+ * was shown. Its windows then move to the same workspaces of a remaining
+ * output, and all of the resulting relayouts are applied as one transaction
+ * batch (see transaction.h), so each client is configured at most once.
+ *
+ * When an output with that name is connected again, the windows that still
+ * belong to it are taken back in one batch as well. Tiled windows get their
+ * old tiles back instead of being inserted one by one, and floating windows
+ * return to their old position. Windows closed in the meantime are dropped
+ * from the saved layout, and windows the user moved to another workspace
+ * stay where they were put.
  */
 
 #ifndef OUTPUT_H
@@ -46,14 +74,20 @@
 
 #include <wayland-server-core.h>
 
+#include "config.h"
 #include "server.h"
+#include "workspace.h"
 
 /**
  * struct tinywl_output - Represents a single display/output
  * @link: List node for server->outputs list
  * @server: Back-pointer to the compositor server
  * @wlr_output: The underlying wlroots output object
+ * @workspaces: The output's numbered workspaces
+ * @active_workspace: The workspace currently shown
+ * @usable_area: Area windows may cover, in layout coordinates
  * @frame: Listener for frame events (time to render)
+ * @throttle_timer: Schedules a frame for callbacks held back by throttling
  * @request_state: Listener for state change requests from backend
  * @destroy: Listener for output disconnect events
  *
@@ -83,10 +117,37 @@ struct tinywl_output {
   /* The underlying wlroots output object */
   struct wlr_output *wlr_output;
 
+  /* Workspaces, exactly one of them is shown. See workspace.h */
+  struct tinywl_workspace workspaces[WORKSPACE_COUNT];
+  struct tinywl_workspace *active_workspace;
+
+  /* Cached when the output layout changes, see server_output_layout_change */
+  struct wlr_box usable_area;
+
   /* Event listeners */
   struct wl_listener frame;         /* Called at refresh rate to render */
   struct wl_listener request_state; /* Backend requests state change */
   struct wl_listener destroy;       /* Output was disconnected */
+
+  /* Frame callback throttling, see FRAME THROTTLING above */
+  struct wl_event_source *throttle_timer;
+};
+
+/**
+ * struct tinywl_saved_output - Layout of an output that went away
+ * @link: List node for server->saved_outputs
+ * @name: Name of the output, matched when an output is connected
+ * @active_workspace: Index of the workspace that was shown
+ * @trees: Saved tiling tree of each workspace, see layout_save()
+ *
+ * The windows themselves point to the saved output they belong to, see
+ * tinywl_toplevel.home.
+ */
+struct tinywl_saved_output {
+  struct wl_list link;
+  char *name;
+  int active_workspace;
+  struct tinywl_container *trees[WORKSPACE_COUNT];
 };
 
 /**
@@ -128,10 +189,56 @@ struct tinywl_output {
  *    - Connects output to scene graph for rendering
  *    - Scene graph automatically handles rendering to this output
  *
+ * 9. Restores the saved layout
+ *    - If an output with the same name went away before, its windows are
+ *      brought back, see HOTPLUG above
+ *
  * AUTOMATIC LAYOUT:
  * We use a simple approach with add_auto, which arranges monitors in the order
  * they're detected.
  */
 void server_new_output(struct wl_listener *listener, void *data);
 
+/**
+ * server_output_layout_change - Handles output arrangement changes
+ * @listener: Wayland listener that triggered this callback
+ * @data: Unused
+ *
+ * Called whenever an output is added, removed, moved, or changes mode. Each
+ * output's usable area is recomputed and cached here, so maximizing a window
+ * or arranging a workspace never has to query the output layout. Outputs
+ * whose area didn't change are left untouched, otherwise the tiling trees of
+ * their workspaces and their maximized windows are fitted to the new area.
+ *
+ * Nothing reserves space at the output edges yet, so the usable area is the
+ * output's whole box.
+ */
+void server_output_layout_change(struct wl_listener *listener, void *data);
+
+/**
+ * output_at - Finds the output at a position in layout coordinates
+ * @server: Server state structure
+ * @lx: X coordinate in layout space
+ * @ly: Y coordinate in layout space
+ *
+ * Return: The output containing the point, or NULL if there is none
+ */
+struct tinywl_output *output_at(struct tinywl_server *server, double lx,
+                                double ly);
+
+/**
+ * output_forget_toplevel - Gives up a window's place on a saved output
+ * @toplevel: The window
+ *
+ * Called when the window is unmapped or moved on purpose, it won't be moved
+ * back when its old output is connected again.
+ */
+void output_forget_toplevel(struct tinywl_toplevel *toplevel);
+
+/**
+ * output_saved_finish - Frees the layouts of outputs that never came back
+ * @server: Server state structure
+ */
+void output_saved_finish(struct tinywl_server *server);
+
 #endif
@@ -0,0 +1,152 @@
+/**
+ * overview.h
+ *
+ * Overview of the windows on an output.
+ *
+ * OVERVIEW:
+ * The overview lays out every window of the shown workspace on the output
+ * under the cursor in a grid, so one can be picked with the pointer or the
+ * keyboard. Opening it zooms the windows out from where they are into their
+ * grid cells, closing it zooms them back in.
+ *
+ * THUMBNAILS:
+ * The grid shows thumbnails (see thumbnail.h) rendered at the size of their
+ * cell, not the windows' own surfaces. Once the zoom-out finished, the
+ * workspace itself is hidden, so the output only composites one small buffer
+ * per window and frame times stay the same with many windows. A thumbnail is
+ * rendered again only when its window committed, and at most once per frame.
+ *
+ * Hidden windows get no frame callbacks from the scene, and many clients
+ * don't draw again without one. A timer sends them frame callbacks at
+ * UNFOCUSED_FRAME_RATE while the workspace is hidden, so their thumbnails
+ * keep up with what they draw.
+ *
+ * ANIMATION:
+ * The zoom is advanced from the output's frame event by the time elapsed
+ * since the previous frame, and schedules the next frame until it is done.
+ * It therefore runs at the output's refresh rate, never faster, and closing
+ * halfway through opening reverses smoothly from where it was.
+ *
+ * INPUT:
+ * While the overview is open, pointer and keyboard input goes to it instead
+ * of clients:
+ * - Moving the pointer over a window selects it, clicking picks it
+ * - Arrow keys or h/j/k/l move the selection, Return picks it
+ * - Escape, or clicking outside every window, closes the overview
+ * - The binding that opened the overview closes it again
+ *
+ * Picking a window focuses it and closes the overview.
+ */
+
+#ifndef OVERVIEW_H
+#define OVERVIEW_H
+
+#include <wayland-server-core.h>
+
+#include "server.h"
+
+/**
+ * struct tinywl_overview_entry - A window shown in the overview
+ * @toplevel: The window, NULL once it was unmapped
+ * @thumbnail: Scene buffer showing the window's thumbnail
+ * @commit_seq: Window's commit count when the thumbnail was taken
+ * @from: The window's box on the workspace, in layout coordinates
+ * @to: The thumbnail's box in the grid, in layout coordinates
+ */
+struct tinywl_overview_entry {
+  struct tinywl_toplevel *toplevel;
+  struct wlr_scene_buffer *thumbnail;
+  uint64_t commit_seq;
+  struct wlr_box from, to;
+};
+
+/**
+ * struct tinywl_overview - State of the open overview
+ * @output: Output the overview is shown on
+ * @workspace: Workspace whose windows are shown
+ * @tree: Scene tree holding the overview, above everything else
+ * @background: Rectangle dimming the output
+ * @selection: Rectangle behind the selected thumbnail
+ * @entries: Shown windows, in MRU order
+ * @entry_count: Number of entries
+ * @columns: Number of grid columns
+ * @selected: Index of the selected entry, -1 if none
+ * @progress: Zoom state, from 0 (windows in place) to 1 (grid)
+ * @closing: Whether the zoom runs towards 0
+ * @last_frame_ns: Time of the previous animation step, 0 before the first
+ * @workspace_hidden: Whether the workspace tree was hidden
+ * @frame_timer: Sends frame callbacks to the windows while they are hidden
+ */
+struct tinywl_overview {
+  struct tinywl_output *output;
+  struct tinywl_workspace *workspace;
+  struct wlr_scene_tree *tree;
+  struct wlr_scene_rect *background;
+  struct wlr_scene_rect *selection;
+  struct tinywl_overview_entry *entries;
+  size_t entry_count;
+  int columns;
+  int selected;
+  double progress;
+  bool closing;
+  uint64_t last_frame_ns;
+  bool workspace_hidden;
+  struct wl_event_source *frame_timer;
+};
+
+/**
+ * overview_toggle - Opens or closes the overview
+ * @server: Server state structure
+ */
+void overview_toggle(struct tinywl_server *server);
+
+/**
+ * overview_frame - Advances the zoom animation
+ * @output: Output that is about to render a frame
+ *
+ * Called from the output's frame event before the scene is committed.
+ */
+void overview_frame(struct tinywl_output *output);
+
+/**
+ * overview_handle_key - Handles a key press while the overview is open
+ * @server: Server state structure
+ * @sym: The keysym that was pressed
+ */
+void overview_handle_key(struct tinywl_server *server, xkb_keysym_t sym);
+
+/**
+ * overview_pointer_motion - Selects the window under the pointer
+ * @server: Server state structure
+ */
+void overview_pointer_motion(struct tinywl_server *server);
+
+/**
+ * overview_pointer_button - Picks the window under the pointer
+ * @server: Server state structure
+ *
+ * Closes the overview without changing focus if there is none.
+ */
+void overview_pointer_button(struct tinywl_server *server);
+
+/**
+ * overview_toplevel_commit - Notes that a window drew something new
+ * @toplevel: The window that committed
+ *
+ * Schedules a frame to refresh the window's thumbnail if it is shown.
+ */
+void overview_toplevel_commit(struct tinywl_toplevel *toplevel);
+
+/**
+ * overview_toplevel_unmap - Forgets a window that is going away
+ * @toplevel: The window being unmapped
+ */
+void overview_toplevel_unmap(struct tinywl_toplevel *toplevel);
+
+/**
+ * overview_output_destroy - Closes the overview at once if on an output
+ * @output: The output being destroyed
+ */
+void overview_output_destroy(struct tinywl_output *output);
+
+#endif
@@ -33,6 +33,22 @@
  *   * Slide: Move along an axis to stay on-screen
  *   * Flip: Switch to opposite side of anchor
  *   * Resize: Shrink popup to fit
+ *
+ * UNCONSTRAINING:
+ * Nocturne applies those rules against the usable area of the window's
+ * output before the popup's first configure, and again whenever the client
+ * repositions it. A menu near the edge of the output is therefore mapped
+ * where it fits on the first try, and a chain of nested submenus opens with
+ * one configure each, instead of being mapped off screen and moved back.
+ *
+ * GRABS:
+ * Menus usually ask for a grab. wlroots keeps the pointer and keyboard on
+ * the client while the grab lasts and dismisses the popups when the user
+ * clicks anywhere else. Nocturne also dismisses the popups of a window when
+ * keyboard focus leaves it, and popups whose parent isn't an xdg surface,
+ * since they have no place in the scene. Focus follows mouse stays put while
+ * a grab lasts, so the pointer crossing another window on its way to a
+ * submenu doesn't close the menu.
  */
 
 #ifndef POPUP_H
@@ -40,10 +56,13 @@
 
 #include <wayland-server-core.h>
 
+struct tinywl_toplevel;
+
 /**
  * struct tinywl_popup - Represents a popup surface
  * @xdg_popup: The underlying wlroots xdg_popup object
  * @commit: Listener for surface commit events
+ * @reposition: Listener for new positioners sent by the client
  * @destroy: Listener for popup destruction
  *
  * Popups are simpler than toplevels - they can't be moved or resized
@@ -72,6 +91,7 @@ struct tinywl_popup {
   
   /* Event listeners */
   struct wl_listener commit; /* Surface state was committed */
+  struct wl_listener reposition; /* Popup was repositioned */
   struct wl_listener destroy; /* Popup was destroyed */
 };
 
@@ -87,6 +107,7 @@ struct tinywl_popup {
  * 2. Finds the parent surface
  *    - Popups must have a parent (toplevel or another popup)
  *    - Parent is specified by the client in the xdg_popup creation
+ *    - Popups without an xdg parent are dismissed right away
  *
  * 3. Adds popup to scene graph
  *    - Uses wlr_scene_xdg_surface_create() helper
@@ -99,6 +120,7 @@ struct tinywl_popup {
  *
  * 5. Registers event listeners
  *    - commit: Handle surface state commits
+ *    - reposition: Fit the popup to the output again
  *    - destroy: Clean up when popup is destroyed
  *
  * PARENT LOOKUP:
@@ -110,8 +132,9 @@ struct tinywl_popup {
  * INITIAL COMMIT:
  * The first commit is special. The client creates the popup, commits
  * initial state, then waits for a configure event from us before
- * actually showing anything. We send an empty configure on the initial
- * commit to allow the popup to map.
+ * actually showing anything. On the initial commit we fit the popup to the
+ * output, see UNCONSTRAINING above, and send the configure that lets the
+ * popup map.
  *
  * POPUP DISMISSAL:
  * The compositor can dismiss popups by sending a popup_done event.
@@ -121,9 +144,18 @@ struct tinywl_popup {
  * - Parent window was unmapped
  * - Focus changed to a different toplevel
  *
- * We don't currently implement popup dismissal logic, but it would
- * go here or in the cursor button handler.
+ * Clicks outside and Escape are handled by wlroots and the client, see GRABS
+ * above, focus changes call popup_dismiss_all().
  */
 void server_new_xdg_popup(struct wl_listener *listener, void *data);
 
+/**
+ * popup_dismiss_all - Dismisses every popup of a window
+ * @toplevel: The window
+ *
+ * Sends popup_done to the window's popups, nested ones first, which also
+ * ends their grab.
+ */
+void popup_dismiss_all(struct tinywl_toplevel *toplevel);
+
 #endif
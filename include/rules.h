@@ -0,0 +1,120 @@
+/**
+ * rules.h
+ *
+ * Window rules.
+ *
+ * OVERVIEW:
+ * Window rules (see config.h) set the floating state, workspace, initial size,
+ * borders, frame throttling and decorations of windows by their app_id and
+ * title. They are applied once, when a window is mapped, except for
+ * decorations, which are settled on the window's initial commit.
+ *
+ * COMPILATION:
+ * The rule table is compiled once at startup:
+ * - Rules naming an app_id are grouped in a hash table keyed by the app_id
+ * - Title patterns are compiled with regcomp()
+ *
+ * Matching a window hashes its app_id once and only looks at the rules for
+ * that app_id, plus the rules that match any app_id. Mapping a window costs the
+ * same however many rules name other applications. Each match is timed and
+ * logged at debug level.
+ *
+ * ORDER:
+ * Every matching rule applies, in table order. A setting of a later rule
+ * overrides the same setting of an earlier one, unset settings are left
+ * alone.
+ */
+
+#ifndef RULES_H
+#define RULES_H
+
+#include <regex.h>
+#include <wayland-server-core.h>
+
+#include "config.h"
+#include "server.h"
+
+/**
+ * struct tinywl_compiled_rule - A rule ready for matching
+ * @rule: The rule from the configuration
+ * @title: Compiled title pattern, valid if has_title is set
+ * @has_title: Whether the rule matches on the title
+ */
+struct tinywl_compiled_rule {
+  const window_rule *rule;
+  regex_t title;
+  bool has_title;
+};
+
+/**
+ * struct tinywl_rule_bucket - Rules for one app_id
+ * @app_id: The app_id, NULL for an empty slot
+ * @hash: Hash of app_id
+ * @rules: Indices into the compiled rules, in table order
+ * @count: Number of entries in rules
+ */
+struct tinywl_rule_bucket {
+  const char *app_id;
+  uint32_t hash;
+  size_t *rules;
+  size_t count;
+};
+
+/**
+ * struct tinywl_rules - The compiled rule table
+ * @rules: Compiled rules, in table order
+ * @count: Number of compiled rules
+ * @buckets: Open addressing hash table of app_ids
+ * @bucket_count: Size of buckets, a power of two
+ * @any: Indices of the rules matching any app_id, in table order
+ * @any_count: Number of entries in any
+ */
+struct tinywl_rules {
+  struct tinywl_compiled_rule *rules;
+  size_t count;
+  struct tinywl_rule_bucket *buckets;
+  size_t bucket_count;
+  size_t *any;
+  size_t any_count;
+};
+
+/**
+ * struct tinywl_rule_result - Settings of every rule matching a window
+ *
+ * The fields are the same as those of window_rule, RULE_UNSET and 0 mean that
+ * no matching rule set them.
+ */
+struct tinywl_rule_result {
+  int floating;
+  int workspace;
+  int width, height;
+  int border;
+  int throttle;
+  int client_decorations;
+};
+
+/**
+ * rules_init - Compiles the window rules from config.h
+ * @server: Server state structure
+ *
+ * Rules with an invalid title pattern are logged and skipped.
+ */
+void rules_init(struct tinywl_server *server);
+
+/**
+ * rules_finish - Frees the compiled window rules
+ * @server: Server state structure
+ */
+void rules_finish(struct tinywl_server *server);
+
+/**
+ * rules_match - Merges the rules matching a window
+ * @server: Server state structure
+ * @app_id: The window's app_id, may be NULL
+ * @title: The window's title, may be NULL
+ * @result: Output parameter for the merged settings
+ */
+void rules_match(struct tinywl_server *server, const char *app_id,
+                 const char *title, struct tinywl_rule_result *result);
+
+#endif
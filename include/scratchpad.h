@@ -0,0 +1,78 @@
+/**
+ * scratchpad.h
+ *
+ * Minimizing windows and the scratchpad.
+ *
+ * OVERVIEW:
+ * A hidden window is taken off its workspace but stays mapped, so its client
+ * keeps running and its last buffer stays in the scene. A hidden window:
+ * - Has its scene node disabled, so it isn't rendered
+ * - Is removed from the tiling layout, the others fill its space
+ * - Isn't in the spatial index, so the pointer can't reach it
+ * - Isn't offered by window cycling, the switcher or the overview
+ * - Gets no frame callbacks, those are only sent for buffers on an output
+ * - Is told that it is suspended (see occlusion.h), so the client can drop
+ *   its GPU and CPU resources
+ *
+ * MINIMIZE:
+ * Windows are minimized by a keybinding or by their client's request.
+ * Restoring brings back the most recently used minimized window on the shown
+ * workspace of the output under the cursor, into the layer it was in.
+ *
+ * SCRATCHPAD:
+ * Windows sent to the scratchpad float and are hidden. Toggling the
+ * scratchpad shows the most recently used scratchpad window centered on the
+ * output under the cursor, or hides it again if it is focused. Showing keeps
+ * the window's size, so there is no configure to wait for and the window
+ * appears on the next frame with the buffer it last drew. Tiling a scratchpad
+ * window takes it out of the scratchpad.
+ */
+
+#ifndef SCRATCHPAD_H
+#define SCRATCHPAD_H
+
+#include <wayland-server-core.h>
+
+#include "server.h"
+
+/**
+ * toplevel_hide - Hides a window
+ * @toplevel: A window on a workspace
+ *
+ * Focus moves to the next window on the workspace if the window had it.
+ */
+void toplevel_hide(struct tinywl_toplevel *toplevel);
+
+/**
+ * toplevel_unhide - Shows a hidden window on a workspace and focuses it
+ * @toplevel: A hidden window
+ * @workspace: Workspace to show it on
+ */
+void toplevel_unhide(struct tinywl_toplevel *toplevel,
+                     struct tinywl_workspace *workspace);
+
+/**
+ * minimize_focused - Minimizes the focused window
+ * @server: Server state structure
+ */
+void minimize_focused(struct tinywl_server *server);
+
+/**
+ * restore_minimized - Restores the most recently used minimized window
+ * @server: Server state structure
+ */
+void restore_minimized(struct tinywl_server *server);
+
+/**
+ * scratchpad_move_focused - Sends the focused window to the scratchpad
+ * @server: Server state structure
+ */
+void scratchpad_move_focused(struct tinywl_server *server);
+
+/**
+ * scratchpad_toggle - Shows or hides a scratchpad window
+ * @server: Server state structure
+ */
+void scratchpad_toggle(struct tinywl_server *server);
+
+#endif
@@ -101,6 +101,10 @@ struct tinywl_server {
   struct wl_listener new_xdg_popup;    /* New popup created */
   struct wl_list toplevels;            /* List of all windows */
 
+  /* Decoration negotiation, see decoration.h */
+  struct wlr_xdg_decoration_manager_v1 *xdg_decoration_manager;
+  struct wl_listener new_toplevel_decoration;
+
   /* Cursor/pointer handling */
   struct wlr_cursor *cursor;                 /* Logical cursor */
   struct wlr_xcursor_manager *cursor_mgr;    /* Cursor themes */
@@ -121,13 +125,57 @@ struct tinywl_server {
   enum tinywl_cursor_mode cursor_mode;      /* Current interaction mode*/
   struct tinywl_toplevel *grabbed_toplevel; /* Window being moved/resized */
   double grab_x, grab_y;                    /* Cursor offset at grab start */
+  struct tinywl_snap_index *snap_index;     /* Edges to snap moves to */
+  bool move_pending;                        /* Move waiting for a frame */
+  int move_x, move_y;                       /* Latest move target */
   struct wlr_box grab_geobox;               /* Window geometry at grab start */
   uint32_t resize_edges;                    /* Which edges being resized */
+  struct wl_event_source *resize_timer;     /* Gives up on a slow client */
+  bool cursor_default;                      /* Default xcursor is shown */
+
+  /* Focus follows mouse, see cursor.h */
+  struct tinywl_toplevel *focus_candidate; /* Window the pointer rests on */
+  uint64_t focus_candidate_ns;             /* When the pointer entered it */
+  bool focus_pending;                      /* Candidate not decided yet */
+  struct wl_event_source *focus_timer;     /* Fires when the dwell is over */
 
   /* Output (monitor) handling */
   struct wlr_output_layout *output_layout; /* Output arrangement*/
   struct wl_list outputs;                  /* List of outputs */
   struct wl_listener new_output;           /* New output connected */
+  struct wl_listener output_layout_change; /* Outputs moved or resized */
+  struct wl_list saved_outputs;            /* Layouts of unplugged outputs */
+
+  /* Layout changes waiting on clients, see transaction.h */
+  struct tinywl_transaction *transaction;
+
+  /* Window selected by a switch in progress, see switcher.h */
+  struct tinywl_toplevel *switcher_selected;
+  struct tinywl_switcher_overlay *switcher_overlay;
+
+  /* Compiled window rules, see rules.h */
+  struct tinywl_rules *rules;
+
+  /* Session being restored, NULL if there was none, see session.h */
+  struct tinywl_session *session;
+
+  /* Open overview, NULL if none, see overview.h */
+  struct tinywl_overview *overview;
+
+  /* Thumbnail cache, most recently used first, see thumbnail.h */
+  struct wl_list thumbnails;
+  size_t thumbnail_bytes;
+
+  /* Running animations, see animation.h */
+  struct wl_list animations;
+  bool animations_disabled; /* Turned off for missing the frame budget */
+  int animation_slow_frames;
+
+  /* Last stacking stamp handed out, see spatial.h */
+  uint64_t stack_counter;
+
+  /* Pending visibility pass, see occlusion.h */
+  struct wl_event_source *occlusion_idle;
 };
 
 /**
@@ -0,0 +1,175 @@
+/**
+ * session.h
+ *
+ * Window arrangement kept across sessions.
+ *
+ * OVERVIEW:
+ * When the compositor exits, the arrangement of the windows is written to
+ * SESSION_FILE:
+ * - Each output's name and shown workspace
+ * - The tiling tree of each workspace, with directions, weights and tabs
+ * - The geometry of floating windows, relative to their output
+ *
+ * Windows are identified by their app_id, windows without one aren't kept.
+ * The next session reads the file at startup and puts each window back in
+ * its place as its application starts.
+ *
+ * FILE FORMAT:
+ * One record per line, fields separated by spaces, the app_id last so it
+ * may contain spaces:
+ *
+ *   nocturne-session 1
+ *   output <name> <shown workspace>
+ *   workspace <index>
+ *   split <depth> <layout> <weight> <active child>
+ *   leaf <depth> <weight> <app_id>
+ *   floating <workspace> <x> <y> <width> <height> <maximized> <app_id>
+ *
+ * A workspace's tree follows its workspace line in pre-order, the root is
+ * the split at depth 0. Lines that can't be parsed are skipped.
+ *
+ * PLACES:
+ * When an output of the saved session is connected, every saved leaf of its
+ * workspaces becomes a placeholder in the tiling tree (see layout.h), and the
+ * tree is arranged once with all of them. Every placeholder and floating
+ * geometry is a place waiting for a window with its app_id.
+ *
+ * PRE-ASSIGNED GEOMETRY:
+ * A window claims the first free place for its app_id on its initial
+ * commit, the first time its app_id is known. The initial configure already
+ * carries the size of the place, so the client's first buffer fits, and the
+ * window is put in its place when it maps. Neither the window nor its
+ * neighbors are configured again, where filling the tree one window at a
+ * time would resize every window already open each time another one starts.
+ *
+ * Places that no window claimed within SESSION_RESTORE_TIMEOUT_MS of startup
+ * are given up, and their space goes to the windows around them.
+ */
+
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <wayland-server-core.h>
+
+#include "config.h"
+#include "server.h"
+
+struct tinywl_output;
+
+/**
+ * struct tinywl_session_slot - A place waiting for a window
+ * @link: List node for session->slots or a saved output's floating list
+ * @app_id: app_id of the window that may claim the place
+ * @workspace: Workspace of the place, NULL until its output is connected
+ * @workspace_index: Index of that workspace on its output
+ * @placeholder: Placeholder leaf, NULL for floating places
+ * @box: Floating geometry, relative to the output
+ * @maximized: Whether the floating window was maximized
+ * @toplevel: Window that claimed the place but isn't mapped yet, or NULL
+ */
+struct tinywl_session_slot {
+  struct wl_list link;
+  char *app_id;
+  struct tinywl_workspace *workspace;
+  int workspace_index;
+  struct tinywl_container *placeholder;
+  struct wlr_box box;
+  bool maximized;
+  struct tinywl_toplevel *toplevel;
+};
+
+/**
+ * struct tinywl_session_output - An output read from the session file
+ * @link: List node for session->outputs
+ * @name: Name of the output, such as "DP-1"
+ * @active_workspace: Index of the workspace it showed
+ * @trees: Tiling tree of each workspace, leaves are placeholders
+ * @floating: Floating places of its workspaces
+ */
+struct tinywl_session_output {
+  struct wl_list link;
+  char *name;
+  int active_workspace;
+  struct tinywl_container *trees[WORKSPACE_COUNT];
+  struct wl_list floating;
+};
+
+/**
+ * struct tinywl_session - The session being restored
+ * @outputs: Saved outputs that weren't connected yet
+ * @slots: Places on connected outputs, in the order they are claimed
+ * @timeout: Timer giving up the places left
+ * @expired: The timer fired, places given back are dropped
+ */
+struct tinywl_session {
+  struct wl_list outputs;
+  struct wl_list slots;
+  struct wl_event_source *timeout;
+  bool expired;
+};
+
+/**
+ * session_init - Reads the session file
+ * @server: Server state structure
+ *
+ * Called before the backend is started, so the first outputs find their
+ * saved arrangement. Does nothing if there is no file.
+ */
+void session_init(struct tinywl_server *server);
+
+/**
+ * session_finish - Frees whatever is left of the restored session
+ * @server: Server state structure
+ *
+ * Remaining placeholders are taken out of the tiling trees.
+ */
+void session_finish(struct tinywl_server *server);
+
+/**
+ * session_save - Writes the current arrangement to the session file
+ * @server: Server state structure
+ *
+ * Called on exit, while the clients are still connected. The file is
+ * replaced atomically.
+ */
+void session_save(struct tinywl_server *server);
+
+/**
+ * session_restore_output - Prepares the places of a connected output
+ * @output: A new output, with its usable area set
+ *
+ * Builds placeholders in the workspaces that are still empty and shows the
+ * saved workspace.
+ */
+void session_restore_output(struct tinywl_output *output);
+
+/**
+ * session_output_destroy - Gives up the places of an output going away
+ * @output: The output, before its workspaces are finished
+ */
+void session_output_destroy(struct tinywl_output *output);
+
+/**
+ * session_claim - Gives a new window a place of the restored session
+ * @toplevel: The window, during its initial commit
+ *
+ * Return: Whether the window claimed a place, the size of the place was then
+ * sent with the initial configure
+ */
+bool session_claim(struct tinywl_toplevel *toplevel);
+
+/**
+ * session_place - Puts a window in the place it claimed
+ * @toplevel: The window, being mapped
+ *
+ * Return: The workspace the window was put on, or NULL if it has no place
+ */
+struct tinywl_workspace *session_place(struct tinywl_toplevel *toplevel);
+
+/**
+ * session_release - Gives back the place of a window that never mapped
+ * @toplevel: The window, being destroyed
+ */
+void session_release(struct tinywl_toplevel *toplevel);
+
+#endif
@@ -0,0 +1,67 @@
+/**
+ * snap.h
+ *
+ * Edge snapping for interactive moves.
+ *
+ * OVERVIEW:
+ * While a window is dragged, its outer edges (geometry plus borders) snap to
+ * nearby edges of outputs and of other visible windows when they come within
+ * SNAP_THRESHOLD pixels, see config.h.
+ *
+ * EDGE INDEX:
+ * Nothing but the grabbed window moves during a drag, so the candidate edges
+ * are collected once when the grab starts. Vertical edges (x coordinates) and
+ * horizontal edges (y coordinates) are kept in two sorted arrays. Each motion
+ * event then finds the nearest edges with a binary search, which costs
+ * O(log n) no matter how many windows are open.
+ *
+ * Snapping is done per axis. On each axis, the window edge that is closest to
+ * a candidate wins, so a window snaps with its left edge or its right edge
+ * but is never stretched.
+ */
+
+#ifndef SNAP_H
+#define SNAP_H
+
+#include <wayland-server-core.h>
+
+#include "server.h"
+
+/**
+ * struct tinywl_snap_index - Sorted edges that a dragged window snaps to
+ * @x_edges: X coordinates of vertical edges, in ascending order
+ * @x_count: Number of entries in x_edges
+ * @y_edges: Y coordinates of horizontal edges, in ascending order
+ * @y_count: Number of entries in y_edges
+ */
+struct tinywl_snap_index {
+  int *x_edges;
+  size_t x_count;
+  int *y_edges;
+  size_t y_count;
+};
+
+/**
+ * snap_index_create - Collects the edges a window can snap to
+ * @server: Server state structure
+ * @skip: The window being moved, its own edges are left out
+ *
+ * Return: The new index, free it with snap_index_destroy()
+ */
+struct tinywl_snap_index *snap_index_create(struct tinywl_server *server,
+                                            struct tinywl_toplevel *skip);
+
+/**
+ * snap_index_destroy - Frees an edge index
+ * @index: The index, may be NULL
+ */
+void snap_index_destroy(struct tinywl_snap_index *index);
+
+/**
+ * snap_box - Snaps a box to the nearest indexed edges
+ * @index: The edge index
+ * @box: Outer box of the window, its position is adjusted in place
+ */
+void snap_box(const struct tinywl_snap_index *index, struct wlr_box *box);
+
+#endif
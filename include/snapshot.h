@@ -0,0 +1,82 @@
+/**
+ * snapshot.h
+ *
+ * Frozen copies of a window's content.
+ *
+ * OVERVIEW:
+ * A snapshot is a scene subtree holding a scene buffer for each buffer that a
+ * window showed at the moment the snapshot was taken. Creating a scene buffer
+ * takes a reference on the client's wlr_buffer, so nothing is copied and the
+ * snapshot stays intact while the client draws new buffers or releases the
+ * old ones.
+ *
+ * SCALING:
+ * A snapshot remembers the geometry size it was taken at. Scaling it to
+ * another size scales every buffer's position and destination size by the
+ * same factors, relative to the geometry origin. The GPU does the scaling
+ * when compositing, so a snapshot can be resized every frame for free.
+ *
+ * Interactive resizes show a snapshot scaled to the size being asked for
+ * until the client catches up, see cursor.h.
+ */
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <wayland-server-core.h>
+
+#include "server.h"
+
+/**
+ * struct tinywl_snapshot_buffer - One buffer of a snapshot
+ * @scene_buffer: Scene buffer showing the frozen wlr_buffer
+ * @box: Position and size at the snapshot's original size
+ */
+struct tinywl_snapshot_buffer {
+  struct wlr_scene_buffer *scene_buffer;
+  struct wlr_box box;
+};
+
+/**
+ * struct tinywl_snapshot - A frozen copy of a window's content
+ * @tree: Scene tree holding the buffers
+ * @width: Geometry width the snapshot was taken at
+ * @height: Geometry height the snapshot was taken at
+ * @buffers: The snapshot's buffers
+ * @buffer_count: Number of entries in buffers
+ */
+struct tinywl_snapshot {
+  struct wlr_scene_tree *tree;
+  int width, height;
+  struct tinywl_snapshot_buffer *buffers;
+  size_t buffer_count;
+};
+
+/**
+ * snapshot_create - Takes a snapshot of a scene subtree
+ * @parent: Tree to put the snapshot in
+ * @content: Subtree whose buffers are captured, positioned relative to parent
+ * @width: Current geometry width of the content
+ * @height: Current geometry height of the content
+ *
+ * Return: The new snapshot, shown at its original size
+ */
+struct tinywl_snapshot *snapshot_create(struct wlr_scene_tree *parent,
+                                        struct wlr_scene_node *content,
+                                        int width, int height);
+
+/**
+ * snapshot_scale - Stretches a snapshot to a geometry size
+ * @snapshot: The snapshot
+ * @width: Geometry width to show the snapshot at
+ * @height: Geometry height to show the snapshot at
+ */
+void snapshot_scale(struct tinywl_snapshot *snapshot, int width, int height);
+
+/**
+ * snapshot_destroy - Removes a snapshot from the scene and frees it
+ * @snapshot: The snapshot, may be NULL
+ */
+void snapshot_destroy(struct tinywl_snapshot *snapshot);
+
+#endif
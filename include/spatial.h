@@ -0,0 +1,131 @@
+/**
+ * spatial.h
+ *
+ * Spatial index for pointer hit-testing.
+ *
+ * OVERVIEW:
+ * Finding the window under the pointer with wlr_scene_node_at() on the scene
+ * root walks every node of the scene, which gets slow with many windows and
+ * runs on every pointer motion event. Instead, every workspace keeps a grid of
+ * the windows on it, and a lookup only looks at the windows registered in the
+ * grid cell under the pointer.
+ *
+ * GRID:
+ * A workspace's grid covers its output's area with square cells of
+ * SPATIAL_CELL_SIZE pixels. Each window is registered in every cell its
+ * bounding box overlaps. The bounding box covers the window's borders and all
+ * of its buffers, so it includes popups, subsurfaces and client-side shadows.
+ * Parts of a window hanging off the output are registered in the nearest edge
+ * cells, and lookups outside an output are clamped the same way.
+ *
+ * Boxes are refreshed whenever a window moves or commits, and a window's cells
+ * only change if its bounding box did.
+ *
+ * STACKING ORDER:
+ * Every window has a stacking key. Floating windows are above tiled ones, and
+ * within a layer the window that was raised or added last has the highest
+ * key. This mirrors the order of the scene tree, see workspace.h.
+ *
+ * LOOKUP:
+ * The cells under the point on each output's shown workspace give a short
+ * list of candidates. They are tried from the highest stacking key down, and
+ * only the candidates whose box contains the point are tested precisely with
+ * wlr_scene_node_at() on their own subtree. That honors input regions, and
+ * stops at the first window that has anything at the point. The cost depends
+ * on how many windows overlap the point, not on how many windows exist.
+ */
+
+#ifndef SPATIAL_H
+#define SPATIAL_H
+
+#include <wayland-server-core.h>
+
+#include "server.h"
+
+struct tinywl_workspace;
+
+/* Side length of a grid cell, in pixels */
+#define SPATIAL_CELL_SIZE 256
+
+/**
+ * struct tinywl_spatial_cell - Windows overlapping one grid cell
+ * @toplevels: The windows, in no particular order
+ * @count: Number of entries in toplevels
+ * @capacity: Allocated size of toplevels
+ */
+struct tinywl_spatial_cell {
+  struct tinywl_toplevel **toplevels;
+  size_t count;
+  size_t capacity;
+};
+
+/**
+ * struct tinywl_spatial_grid - Grid of windows covering an output
+ * @area: Area covered by the grid, in layout coordinates
+ * @columns: Number of cell columns
+ * @rows: Number of cell rows
+ * @cells: The cells, row by row
+ */
+struct tinywl_spatial_grid {
+  struct wlr_box area;
+  int columns, rows;
+  struct tinywl_spatial_cell *cells;
+};
+
+/**
+ * spatial_grid_finish - Frees a grid's cells
+ * @grid: The grid
+ */
+void spatial_grid_finish(struct tinywl_spatial_grid *grid);
+
+/**
+ * spatial_workspace_set_area - Resizes a workspace's grid
+ * @workspace: The workspace
+ * @area: The area of the workspace's output
+ *
+ * Rebuilds the grid and registers the workspace's windows again. Called when
+ * the output's area changes.
+ */
+void spatial_workspace_set_area(struct tinywl_workspace *workspace,
+                                const struct wlr_box *area);
+
+/**
+ * spatial_update_toplevel - Refreshes a window's place in the index
+ * @toplevel: A window on a workspace
+ *
+ * Called after the window moved, committed, or changed workspace.
+ */
+void spatial_update_toplevel(struct tinywl_toplevel *toplevel);
+
+/**
+ * spatial_remove_toplevel - Removes a window from the index
+ * @toplevel: The window
+ */
+void spatial_remove_toplevel(struct tinywl_toplevel *toplevel);
+
+/**
+ * spatial_raise_toplevel - Puts a window on top of its layer's stacking order
+ * @toplevel: The window
+ *
+ * Must be called whenever the window's scene node is raised to the top.
+ */
+void spatial_raise_toplevel(struct tinywl_toplevel *toplevel);
+
+/**
+ * spatial_toplevel_at - Finds the window under a point
+ * @server: Server state structure
+ * @lx: X coordinate in layout space
+ * @ly: Y coordinate in layout space
+ * @surface: Output parameter for the surface at this position
+ * @sx: Output parameter for surface-relative X coordinate
+ * @sy: Output parameter for surface-relative Y coordinate
+ *
+ * Return: The topmost window with a surface at the point, or NULL if the
+ * point is over nothing or over something that isn't a client surface
+ */
+struct tinywl_toplevel *spatial_toplevel_at(struct tinywl_server *server,
+                                            double lx, double ly,
+                                            struct wlr_surface **surface,
+                                            double *sx, double *sy);
+
+#endif
@@ -0,0 +1,97 @@
+/**
+ * switcher.h
+ *
+ * Keyboard window switcher (Alt+Tab).
+ *
+ * OVERVIEW:
+ * server->toplevels is kept in most recently used order: focus_toplevel()
+ * moves the focused window to the front of the list, which is a constant time
+ * unlink and insert. The switcher walks that list.
+ *
+ * SWITCHING:
+ * Pressing Tab while MODKEY is held starts a switch at the focused window and
+ * selects the next window in MRU order, Shift+Tab selects the previous one.
+ * Further presses keep walking the list in either direction, wrapping around
+ * at its ends. Only windows on shown workspaces are selected.
+ *
+ * While switching, the selection is only shown with the focused border color,
+ * which the focused window gives up until the switch ends.
+ * Windows passed over are not raised, activated or given keyboard focus, so
+ * neither clients nor the scene see the intermediate steps. Releasing MODKEY
+ * focuses the selected window, which also moves it to the front of the MRU
+ * list. A quick Alt+Tab therefore goes back to the previously used window.
+ *
+ * OVERLAY:
+ * While switching, the output under the cursor shows a grid of thumbnails of
+ * the selectable windows in MRU order, with the selection highlighted. The
+ * overlay is built once when the switch starts, later steps only move the
+ * highlight. Windows that don't fit on the output are left out, so their
+ * thumbnails aren't rendered either. Thumbnails come from a cache and are
+ * only rendered again for windows that committed, see thumbnail.h.
+ */
+
+#ifndef SWITCHER_H
+#define SWITCHER_H
+
+#include <wayland-server-core.h>
+
+#include "server.h"
+
+/**
+ * struct tinywl_switcher_entry - A window shown in the overlay
+ * @toplevel: The window, NULL once it was unmapped
+ * @x: X position of its cell in the overlay
+ * @y: Y position of its cell in the overlay
+ */
+struct tinywl_switcher_entry {
+  struct tinywl_toplevel *toplevel;
+  int x, y;
+};
+
+/**
+ * struct tinywl_switcher_overlay - Thumbnails shown while switching
+ * @tree: Scene tree holding the overlay, above everything else
+ * @selection: Rectangle behind the selected window's thumbnail
+ * @entries: Shown windows, in MRU order
+ * @entry_count: Number of entries
+ */
+struct tinywl_switcher_overlay {
+  struct wlr_scene_tree *tree;
+  struct wlr_scene_rect *selection;
+  struct tinywl_switcher_entry *entries;
+  size_t entry_count;
+};
+
+/**
+ * switcher_next - Selects the next window in MRU order
+ * @server: Server state structure
+ *
+ * Starts a switch if none is in progress.
+ */
+void switcher_next(struct tinywl_server *server);
+
+/**
+ * switcher_prev - Selects the previous window in MRU order
+ * @server: Server state structure
+ *
+ * Starts a switch if none is in progress.
+ */
+void switcher_prev(struct tinywl_server *server);
+
+/**
+ * switcher_commit - Ends a switch and focuses the selected window
+ * @server: Server state structure
+ *
+ * Called when MODKEY is released. Does nothing if no switch is in progress.
+ */
+void switcher_commit(struct tinywl_server *server);
+
+/**
+ * switcher_toplevel_unmap - Forgets a window that is going away
+ * @toplevel: The window being unmapped
+ *
+ * Cancels the switch if the window was selected, focus stays where it was.
+ */
+void switcher_toplevel_unmap(struct tinywl_toplevel *toplevel);
+
+#endif
@@ -0,0 +1,82 @@
+/**
+ * thumbnail.h
+ *
+ * Cached, downscaled renderings of windows.
+ *
+ * OVERVIEW:
+ * The switcher overlay (see switcher.h) shows a small picture of every window.
+ * A thumbnail is rendered by drawing the buffers of the window's scene subtree
+ * into a buffer from the server's allocator, scaled down so that it fits in
+ * the size the caller asks for. The GPU samples the client textures that the
+ * renderer already holds, nothing is read back to the CPU.
+ *
+ * LAZY RENDERING:
+ * Every toplevel counts its commits, including those of its subsurfaces,
+ * which video players and embedded GL views update on their own. A thumbnail
+ * remembers the count it was rendered at, and is only rendered again when the
+ * window committed since or is asked for at another size. Opening the
+ * switcher or the overview (see overview.h) repeatedly over idle windows
+ * renders nothing.
+ *
+ * CACHE:
+ * Thumbnails are kept in server->thumbnails in least recently used order. When
+ * their total size goes over THUMBNAIL_CACHE_SIZE, the least recently used
+ * ones are dropped. A dropped thumbnail that is still shown stays alive until
+ * the scene lets go of its buffer. A window's thumbnail is discarded when the
+ * window is unmapped.
+ */
+
+#ifndef THUMBNAIL_H
+#define THUMBNAIL_H
+
+#include <wayland-server-core.h>
+
+#include "server.h"
+
+/**
+ * struct tinywl_thumbnail - A rendered thumbnail
+ * @link: Entry in server->thumbnails, most recently used first
+ * @toplevel: The window it shows
+ * @buffer: The rendering, owned by the cache
+ * @commit_seq: Window's commit count when it was rendered
+ * @size: Size of buffer in bytes
+ */
+struct tinywl_thumbnail {
+  struct wl_list link;
+  struct tinywl_toplevel *toplevel;
+  struct wlr_buffer *buffer;
+  uint64_t commit_seq;
+  size_t size;
+};
+
+/**
+ * thumbnail_get - Returns a window's thumbnail, rendering it if needed
+ * @toplevel: A mapped window
+ * @max_width: Largest width of the thumbnail
+ * @max_height: Largest height of the thumbnail
+ *
+ * The thumbnail keeps the aspect ratio of the window's geometry, and is never
+ * larger than the window itself.
+ *
+ * The buffer is owned by the cache, lock it or hand it to a scene buffer to
+ * keep it past the next call.
+ *
+ * Return: The thumbnail, or NULL if the window has nothing to show or the
+ * buffer could not be allocated
+ */
+struct wlr_buffer *thumbnail_get(struct tinywl_toplevel *toplevel,
+                                 int max_width, int max_height);
+
+/**
+ * thumbnail_discard - Drops a window's thumbnail from the cache
+ * @toplevel: The window
+ */
+void thumbnail_discard(struct tinywl_toplevel *toplevel);
+
+/**
+ * thumbnail_finish - Drops every cached thumbnail
+ * @server: Server state structure
+ */
+void thumbnail_finish(struct tinywl_server *server);
+
+#endif
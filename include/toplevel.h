@@ -58,6 +58,7 @@
 #ifndef TOPLEVEL_H
 #define TOPLEVEL_H
 
+#include <time.h>
 #include <wayland-server-core.h>
 
 #include "server.h"
@@ -68,18 +69,54 @@
  * @server: Back-pointer to the compositor server
  * @xdg_toplevel: The underlying wlroots xdg_toplevel object
  * @scene_tree: Scene graph node for this window
+ * @content_tree: Scene subtree holding the client's surfaces and popups
  * @border_top: Scene rectangle for top border
  * @border_bottom: Scene rectangle for bottom border
  * @border_left: Scene rectangle for left border
  * @border_right: Scene rectangle for right border
+ * @border_geo_width: Geometry width the borders were last fitted to
+ * @border_geo_height: Geometry height the borders were last fitted to
+ * @borders_enabled: Whether the borders are currently shown
+ * @border_focused: Whether the borders currently have the focused color
+ * @workspace: Workspace the window is on, NULL while unmapped
+ * @container: Leaf of the tiling tree holding this window, NULL if floating
+ * @tile: Area last assigned by the tiling layout, minus borders
+ * @maximized: Whether the window covers its output's usable area
+ * @floating_box: Geometry to restore when the window is unmaximized
+ * @txn_link: List node for the server's transaction
+ * @txn_serial: Configure serial the transaction is waiting on, 0 if none
+ * @in_transaction: Whether the window has a tile waiting to be applied
+ * @awaiting_placement: Whether the window is hidden until its first tile
+ * @suspended: Whether the client was told that the window can't be seen
+ * @hidden: Whether the window is minimized or in the scratchpad
+ * @hidden_tiled: Whether the window was tiled when it was hidden
+ * @scratchpad: Whether the window belongs to the scratchpad
+ * @borders_hidden: Whether a window rule turned the borders off
+ * @unthrottled: Whether a window rule turned frame throttling off
+ * @last_frame_ns: When the window last got frame callbacks, see output.h
+ * @resize_serial: Outstanding interactive resize configure, 0 if none
+ * @resize_box: Box requested by the outstanding resize configure
+ * @resize_queued_box: Newest box of the resize, not sent yet
+ * @resize_queued: Whether resize_queued_box is waiting to be sent
+ * @resize_edges: Edges dragged by the resize (WLR_EDGE_*)
+ * @resize_snapshot: Frozen content shown while the client catches up
+ * @commit_seq: Number of commits so far, subsurfaces included, see
+ *              thumbnail.h
+ * @subsurfaces: Watches counting the commits of the window's subsurfaces
+ * @thumbnail: Cached thumbnail, NULL if none
+ * @index_box: Bounding box registered in the spatial index
+ * @index_workspace: Workspace whose grid holds the window, NULL if none
+ * @stack_stamp: Stacking order within the window's layer, see spatial.h
  * @map: Listener for surface map event (window becomes visible)
  * @unmap: Listener for surface unmap event (window becomes invisible)
  * @commit: Listener for surface commit event (new state committed)
+ * @new_subsurface: Listener for subsurfaces added to the window's surface
  * @destroy: Listener for toplevel destruction
  * @request_move: Listener for move requests from client
  * @request_resize: Listener for resize requests from client
  * @request_maximize: Listener for maximize requests from client
  * @request_fullscreen: Listener for fullscreen requests from client
+ * @request_minimize: Listener for minimize requests from client
  *
  * Each application window gets one of these structs. It tracks:
  * - The xdg_toplevel (contains window properties, state, geometry)
@@ -94,12 +131,24 @@
  * - Can be moved/raised/lowered in the scene
  * - Automatically clips to output boundaries
  *
+ * The node's position is the top-left corner of the window geometry, not of
+ * the surface. Clients drawing their own shadows have surfaces larger than
+ * their geometry, so the client's surfaces live in a content subtree that is
+ * offset by the geometry's x and y. This lets the layout code place windows
+ * without caring about client-side shadows.
+ *
  * The scene tree makes rendering automatic, we update the tree structure and
  * wlroots figures out what needs to be redrawn.
  *
  * BORDERS:
- * Nocturne draws server-side borders (decorations) around windows. The color
- * and width of these borders will be configurable in the future.
+ * Nocturne draws server-side borders (decorations) around windows. Their
+ * width and their focused and unfocused colors are set in config.h. Maximized
+ * windows have no borders, and their commits skip the border update.
+ *
+ * The border state last applied is cached, so the scene is only touched when
+ * the window's size, visibility or focus actually changed. A client that
+ * commits every frame at the same size, like a video player, costs no border
+ * work at all.
  *
  * XDG Decoration protocol lets clients and compositor negotiate which to use
  *
@@ -135,16 +184,87 @@ struct tinywl_toplevel {
   /* Scene graph node for this window and its decorations */
   struct wlr_scene_tree *scene_tree;
 
+  /* Client surfaces, offset so that scene_tree sits at the geometry origin */
+  struct wlr_scene_tree *content_tree;
+
   /* Border decorations (server-side) */
   struct wlr_scene_rect *border_top;
   struct wlr_scene_rect *border_bottom;
   struct wlr_scene_rect *border_left;
   struct wlr_scene_rect *border_right;
 
+  /* Border state last applied, see toplevel_update_borders() */
+  int border_geo_width, border_geo_height;
+  bool borders_enabled;
+  bool border_focused;
+
+  /* Placement */
+  struct tinywl_workspace *workspace;  /* Workspace the window is on */
+  struct tinywl_container *container;  /* Tiling leaf, NULL if floating */
+  struct wlr_box tile;                 /* Last tile assigned by the layout */
+  bool maximized;                      /* Covers the output's usable area */
+  bool tab_hidden;                     /* In a tab that isn't shown */
+  struct wlr_box floating_box;         /* Restored when unmaximized */
+
+  /* Transaction state, see transaction.h */
+  struct wl_list txn_link;   /* Link in the server's transaction */
+  uint32_t txn_serial;       /* Configure being waited on, 0 if none */
+  bool in_transaction;       /* Tile is waiting to be applied */
+  bool awaiting_placement;   /* Hidden until the first tile is applied */
+
+  /* Last suspended state sent, see occlusion.h */
+  bool suspended;
+
+  /* Minimized or scratchpad, see scratchpad.h */
+  bool hidden;
+  bool hidden_tiled;
+  bool scratchpad;
+
+  /* Set by window rules, see rules.h */
+  bool borders_hidden;
+  bool unthrottled;
+
+  /* Place on an output that went away, see output.h */
+  struct tinywl_saved_output *home;
+  struct tinywl_container *home_leaf; /* Leaf in its saved tiling tree */
+  int home_workspace;
+  bool home_floating;
+  struct wlr_box home_box;            /* Relative to the output */
+
+  /* Decoration mode negotiation, NULL if unsupported, see decoration.h */
+  struct wlr_xdg_toplevel_decoration_v1 *decoration;
+  struct wl_listener decoration_request_mode;
+  struct wl_listener decoration_destroy;
+
+  /* Place in the restored session, until mapped, see session.h */
+  struct tinywl_session_slot *session_slot;
+
+  /* Frame callback throttling, see output.h */
+  uint64_t last_frame_ns;
+
+  /* Interactive resize throttling, see cursor.h */
+  uint32_t resize_serial;
+  struct wlr_box resize_box;
+  struct wlr_box resize_queued_box;
+  bool resize_queued;
+  uint32_t resize_edges;
+  struct tinywl_snapshot *resize_snapshot;
+
+  /* Switcher thumbnail, see thumbnail.h */
+  uint64_t commit_seq;
+  struct wl_list subsurfaces;
+  struct tinywl_thumbnail *thumbnail;
+
+  /* Hit-testing, see spatial.h */
+  struct wlr_box index_box;
+  struct tinywl_workspace *index_workspace;
+  uint64_t stack_stamp;
+
   /* Lifecycle event listeners */
   struct wl_listener map;     /* Window becomes visible*/
   struct wl_listener unmap;   /* Window becomes invisible */
   struct wl_listener commit;  /* New surface state committed */
+  struct wl_listener new_subsurface; /* Subsurface added */
   struct wl_listener destroy; /* Window is being destroyed */
 
   /* Client request listeners */
@@ -152,6 +272,7 @@ struct tinywl_toplevel {
   struct wl_listener request_resize;     /* Client wants to resize window */
   struct wl_listener request_maximize;   /* Client wants to maximize */
   struct wl_listener request_fullscreen; /* Clients wants fullscreen */
+  struct wl_listener request_minimize;   /* Client wants to be minimized */
 };
 
 /**
@@ -177,4 +298,88 @@ struct tinywl_toplevel {
  */
 void server_new_xdg_toplevel(struct wl_listener *listener, void *data);
 
+/**
+ * toplevel_set_tile - Places a window in the area given by the layout
+ * @toplevel: The window to place
+ * @box: The tile in layout coordinates, including borders
+ *
+ * Assigns the window its place inside the tile, leaving room for the
+ * borders. A configure with the new size is only sent when the size actually
+ * changed, so moving a window within the layout costs the client nothing.
+ *
+ * The scene node isn't moved here. The window joins the server's transaction
+ * and is moved together with every other window once the clients caught up.
+ */
+void toplevel_set_tile(struct tinywl_toplevel *toplevel,
+                       const struct wlr_box *box);
+
+/**
+ * toplevel_preset_tile - Sends a window that isn't mapped yet its tile size
+ * @toplevel: The window, during its initial commit
+ * @box: The tile it will be given when mapped, including borders
+ *
+ * The size goes out with the initial configure, so the client's first
+ * buffer already fits. When the window is then given this tile, it only has
+ * to be put in place, see session.h.
+ */
+void toplevel_preset_tile(struct tinywl_toplevel *toplevel,
+                          const struct wlr_box *box);
+
+/**
+ * toplevel_set_maximized - Maximizes or restores a floating window
+ * @toplevel: The window
+ * @maximized: Whether the window should be maximized
+ *
+ * A maximized window covers the usable area of its output, as cached by the
+ * output. Its floating geometry is saved on the way in and restored on the
+ * way out. Maximizing an already maximized window fits it to the current
+ * usable area. Tiled windows are left alone, the layout places them.
+ *
+ * Like toplevel_set_tile(), this only adds the window to the server's
+ * transaction, the caller commits it.
+ */
+void toplevel_set_maximized(struct tinywl_toplevel *toplevel, bool maximized);
+
+/**
+ * toplevel_update_borders - Fits the border rectangles to the window
+ * @toplevel: The window
+ *
+ * Sizes and positions the four border rectangles around the current window
+ * geometry, or around the resize snapshot while there is one. The borders of
+ * maximized windows are hidden instead. Does nothing if neither the size nor
+ * the visibility of the borders changed since the last call.
+ */
+void toplevel_update_borders(struct tinywl_toplevel *toplevel);
+
+/**
+ * toplevel_set_activated - Tells a window whether it has keyboard focus
+ * @toplevel: The window
+ * @activated: Whether the window is focused
+ *
+ * Sends the activated state to the client and switches the border color.
+ */
+void toplevel_set_activated(struct tinywl_toplevel *toplevel, bool activated);
+
+/**
+ * toplevel_set_border_focused - Switches the border color only
+ * @toplevel: The window
+ * @focused: Whether to use the focused border color
+ *
+ * Used to highlight a window without telling the client, see switcher.h.
+ */
+void toplevel_set_border_focused(struct tinywl_toplevel *toplevel,
+                                 bool focused);
+
+/**
+ * toplevel_send_frame_done - Sends frame callbacks to a window
+ * @toplevel: The window
+ * @when: Time of the output frame
+ *
+ * The scene only sends frame callbacks to surfaces it renders. Windows whose
+ * content is hidden behind something else get them from here, since many
+ * clients don't draw again until their last frame callback was answered.
+ */
+void toplevel_send_frame_done(struct tinywl_toplevel *toplevel,
+                              const struct timespec *when);
+
 #endif
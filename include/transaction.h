@@ -0,0 +1,129 @@
+/**
+ * transaction.h
+ *
+ * Atomic application of layout changes.
+ *
+ * OVERVIEW:
+ * A single layout change can resize many windows at once, for example when a
+ * window is opened next to ten others. Each client answers the configure in
+ * its own time. If every window moved as soon as the layout was computed, the
+ * user would see a few frames where some windows have their new size and
+ * others still have the old one, overlapping or leaving gaps.
+ *
+ * Instead, layout changes are collected into a transaction:
+ * 1. The layout assigns new tiles, see toplevel_set_tile()
+ * 2. Windows whose size changed are sent a configure, and the serial is kept
+ * 3. Each window's commit is checked against its serial
+ * 4. Once every window has acked and committed, or the timeout expires, all
+ *    scene nodes are moved at once
+ *
+ * Since all scene changes happen in the same event loop iteration, they are
+ * rendered in the same frame, and no frame shows a half-applied layout.
+ *
+ * MERGING:
+ * Layout changes made while a transaction is waiting join that transaction
+ * rather than starting another one. The timeout isn't restarted, so a client
+ * that keeps triggering relayouts can't delay the result indefinitely.
+ *
+ * BATCHES:
+ * Some events change many layouts one after the other, for example moving
+ * every window of a disconnected output to another one. Each step commits
+ * the transaction on its own, so the first steps would be applied before the
+ * later ones were even computed. Wrapping such a change in
+ * transaction_begin_batch() and transaction_end_batch() holds every commit
+ * until the batch ends, and the whole change is applied at once. Clients are
+ * configured when the event loop goes idle, so a window resized several
+ * times within the batch only gets one configure, with its final size.
+ *
+ * TIMEOUT:
+ * A frozen or slow client must not freeze the layout for everyone else. After
+ * TRANSACTION_TIMEOUT_MS the transaction is applied regardless, and late
+ * clients simply catch up on their own.
+ */
+
+#ifndef TRANSACTION_H
+#define TRANSACTION_H
+
+#include <wayland-server-core.h>
+
+#include "server.h"
+
+/* Longest time to wait for clients before applying a layout anyway */
+#define TRANSACTION_TIMEOUT_MS 200
+
+/**
+ * struct tinywl_transaction - Layout changes waiting to be applied
+ * @toplevels: Windows with a new tile, linked by tinywl_toplevel.txn_link
+ * @num_waiting: Number of those windows that haven't acked their configure
+ * @timeout: Timer that applies the transaction if clients are too slow
+ * @in_flight: Whether the transaction was committed and is waiting on clients
+ * @batch_depth: Number of batches in progress, commits are held while nonzero
+ */
+struct tinywl_transaction {
+  struct wl_list toplevels;
+  size_t num_waiting;
+  struct wl_event_source *timeout;
+  bool in_flight;
+  int batch_depth;
+};
+
+/**
+ * transaction_init - Prepares the server's transaction state
+ * @server: Server state structure
+ */
+void transaction_init(struct tinywl_server *server);
+
+/**
+ * transaction_finish - Releases the server's transaction state
+ * @server: Server state structure
+ */
+void transaction_finish(struct tinywl_server *server);
+
+/**
+ * transaction_add_toplevel - Adds a window with a new tile
+ * @toplevel: The window whose tile changed
+ * @serial: Serial of the configure sent for the new size, or 0 if the size
+ *          didn't change and only the position will be updated
+ */
+void transaction_add_toplevel(struct tinywl_toplevel *toplevel,
+                              uint32_t serial);
+
+/**
+ * transaction_remove_toplevel - Drops a window from the transaction
+ * @toplevel: The window, called when it is unmapped
+ */
+void transaction_remove_toplevel(struct tinywl_toplevel *toplevel);
+
+/**
+ * transaction_commit - Starts waiting for the collected changes
+ * @server: Server state structure
+ *
+ * Called once a layout change is complete. If no window needs to be waited
+ * on, the changes are applied right away. Does nothing during a batch.
+ */
+void transaction_commit(struct tinywl_server *server);
+
+/**
+ * transaction_begin_batch - Holds commits until the batch ends
+ * @server: Server state structure
+ *
+ * Batches nest, the transaction is committed when the outermost one ends.
+ */
+void transaction_begin_batch(struct tinywl_server *server);
+
+/**
+ * transaction_end_batch - Commits the changes collected during a batch
+ * @server: Server state structure
+ */
+void transaction_end_batch(struct tinywl_server *server);
+
+/**
+ * transaction_notify_commit - Checks a window's commit against its configure
+ * @toplevel: The window that committed
+ *
+ * Called from the toplevel's commit handler. When the last window the
+ * transaction was waiting on has acked, the transaction is applied.
+ */
+void transaction_notify_commit(struct tinywl_toplevel *toplevel);
+
+#endif
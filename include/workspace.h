@@ -0,0 +1,180 @@
+/**
+ * workspace.h
+ *
+ * Numbered workspaces per output.
+ *
+ * OVERVIEW:
+ * Every output has WORKSPACE_COUNT workspaces, and shows exactly one of them
+ * at a time. Each workspace owns:
+ * - A scene tree that all of its windows are parented to
+ * - A tiling tree (see layout.h) covering the output
+ * - A grid of its windows used for hit-testing (see spatial.h)
+ *
+ * LAYERS:
+ * A workspace's scene tree holds two layers, tiled windows are parented to
+ * the tiled layer and floating windows to the floating layer above it.
+ * Floating windows therefore always stay on top of tiled ones, and raising a
+ * window only reorders the siblings within its own layer.
+ *
+ * HIDDEN WORKSPACES:
+ * The scene trees of hidden workspaces are disabled. wlroots skips disabled
+ * subtrees entirely, so windows parked on hidden workspaces are never
+ * traversed when rendering, never hit-tested by wlr_scene_node_at(), and
+ * never get frame callbacks, because wlroots only sends those to buffers that
+ * are visible on an output. Clients on hidden workspaces therefore stop
+ * drawing on their own.
+ *
+ * SWITCHING:
+ * Switching workspaces disables one scene tree and enables another. The cost
+ * doesn't depend on how many windows are on the other workspaces, and the
+ * change shows up in the next frame. Hidden workspaces are still kept laid
+ * out, so their windows already have the right size when they are shown.
+ */
+
+#ifndef WORKSPACE_H
+#define WORKSPACE_H
+
+#include <wayland-server-core.h>
+
+#include "server.h"
+#include "spatial.h"
+
+/**
+ * struct tinywl_workspace - A set of windows shown together on an output
+ * @output: Output this workspace belongs to
+ * @index: Position of the workspace on its output, starting at 0
+ * @tree: Scene tree holding the workspace's windows
+ * @tiled_tree: Layer holding the tiled windows
+ * @floating_tree: Layer holding the floating windows, above the tiled ones
+ * @root: Root of the workspace's tiling tree
+ * @grid: Spatial index of the workspace's windows, see spatial.h
+ */
+struct tinywl_workspace {
+  struct tinywl_output *output;
+  int index;
+  struct wlr_scene_tree *tree;
+  struct wlr_scene_tree *tiled_tree;
+  struct wlr_scene_tree *floating_tree;
+  struct tinywl_container *root;
+  struct tinywl_spatial_grid grid;
+};
+
+/**
+ * workspace_init - Sets up a workspace of an output
+ * @workspace: Workspace to initialize
+ * @output: Output it belongs to
+ * @index: Position of the workspace on the output
+ *
+ * Workspaces start hidden, the output shows one with workspace_show().
+ */
+void workspace_init(struct tinywl_workspace *workspace,
+                    struct tinywl_output *output, int index);
+
+/**
+ * workspace_finish - Releases a workspace's scene and tiling trees
+ * @workspace: An empty workspace
+ */
+void workspace_finish(struct tinywl_workspace *workspace);
+
+/**
+ * workspace_add_toplevel - Puts a window on a workspace
+ * @workspace: Destination workspace
+ * @toplevel: A window that isn't on any workspace
+ * @tile: Whether the window should be tiled or floating
+ *
+ * The window's scene node is parented to the matching layer.
+ */
+void workspace_add_toplevel(struct tinywl_workspace *workspace,
+                            struct tinywl_toplevel *toplevel, bool tile);
+
+/**
+ * workspace_fill_placeholder - Tiles a window in a placeholder of a workspace
+ * @workspace: Workspace whose tiling tree holds the placeholder
+ * @toplevel: A window that isn't on any workspace
+ * @placeholder: The placeholder, see layout.h
+ */
+void workspace_fill_placeholder(struct tinywl_workspace *workspace,
+                                struct tinywl_toplevel *toplevel,
+                                struct tinywl_container *placeholder);
+
+/**
+ * workspace_remove_toplevel - Takes a window off its workspace
+ * @toplevel: The window
+ *
+ * The window is removed from the tiling tree and its scene node is parked
+ * under the scene root, disabled workspaces no longer hide it.
+ */
+void workspace_remove_toplevel(struct tinywl_toplevel *toplevel);
+
+/**
+ * workspace_move_toplevel - Moves a window to another workspace
+ * @toplevel: The window
+ * @workspace: Destination workspace
+ *
+ * Tiled windows are tiled on the destination, floating windows keep their
+ * position relative to the output.
+ */
+void workspace_move_toplevel(struct tinywl_toplevel *toplevel,
+                             struct tinywl_workspace *workspace);
+
+/**
+ * workspace_set_floating - Moves a window between the tiled and floating layer
+ * @toplevel: A window on a workspace
+ * @floating: Whether the window should float
+ *
+ * A window that starts floating gets back the geometry it had when it last
+ * floated. The geometry is remembered when it is tiled again, so toggling
+ * back and forth always restores the same floating size and position.
+ */
+void workspace_set_floating(struct tinywl_toplevel *toplevel, bool floating);
+
+/**
+ * toggle_floating_focused - Toggles whether the focused window floats
+ * @server: Server state structure
+ */
+void toggle_floating_focused(struct tinywl_server *server);
+
+/**
+ * workspace_restore_layout - Puts windows back into a saved tiling tree
+ * @workspace: Workspace of a new output, with an empty tiling tree
+ * @saved: Tree saved with layout_save() when an output went away, consumed
+ *
+ * The windows of the saved tree are taken off the workspaces they were moved
+ * to, and the tree is rebuilt around them as it was. Windows that were
+ * closed, hidden or made floating in the meantime are left out.
+ */
+void workspace_restore_layout(struct tinywl_workspace *workspace,
+                              struct tinywl_container *saved);
+
+/**
+ * workspace_show - Makes a workspace the visible one on its output
+ * @workspace: Workspace to show
+ *
+ * Hides the previously visible workspace and focuses the most recently
+ * focused window on the new one.
+ */
+void workspace_show(struct tinywl_workspace *workspace);
+
+/**
+ * focus_workspace - Focuses the most recently used window on a workspace
+ * @workspace: The workspace
+ *
+ * Clears keyboard focus if the workspace has no windows.
+ */
+void focus_workspace(struct tinywl_workspace *workspace);
+
+/**
+ * switch_workspace - Shows a workspace on the output under the cursor
+ * @server: Server state structure
+ * @index: Position of the workspace, starting at 0
+ */
+void switch_workspace(struct tinywl_server *server, int index);
+
+/**
+ * move_focused_to_workspace - Sends the focused window to another workspace
+ * @server: Server state structure
+ * @index: Position of the workspace on the window's output, starting at 0
+ */
+void move_focused_to_workspace(struct tinywl_server *server, int index);
+
+#endif
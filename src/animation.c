@@ -0,0 +1,258 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "animation.h"
+#include "config.h"
+#include "occlusion.h"
+#include "output.h"
+#include "snapshot.h"
+#include "spatial.h"
+#include "toplevel.h"
+#include "utils.h"
+#include "workspace.h"
+
+static bool animations_enabled(struct tinywl_server *server) {
+  return ANIMATION_DURATION_MS > 0 && !server->animations_disabled;
+}
+
+static void set_opacity_iterator(struct wlr_scene_buffer *buffer, int sx,
+                                 int sy, void *user_data) {
+  (void)sx; // coordinates are unused here
+  (void)sy;
+  wlr_scene_buffer_set_opacity(buffer, *(float *)user_data);
+}
+
+static void set_border_color(struct tinywl_toplevel *toplevel,
+                             const float color[4]) {
+  wlr_scene_rect_set_color(toplevel->border_top, color);
+  wlr_scene_rect_set_color(toplevel->border_bottom, color);
+  wlr_scene_rect_set_color(toplevel->border_left, color);
+  wlr_scene_rect_set_color(toplevel->border_right, color);
+}
+
+static void animation_step(struct tinywl_animation *anim, double t) {
+  switch (anim->type) {
+  case TINYWL_ANIMATION_FADE_IN: {
+    float opacity = (float)t;
+    wlr_scene_node_for_each_buffer(anim->node, set_opacity_iterator,
+                                   &opacity);
+    break;
+  }
+  case TINYWL_ANIMATION_FADE_OUT: {
+    float opacity = (float)(1.0 - t);
+    for (size_t i = 0; i < anim->snapshot->buffer_count; i++) {
+      wlr_scene_buffer_set_opacity(anim->snapshot->buffers[i].scene_buffer,
+                                   opacity);
+    }
+    break;
+  }
+  case TINYWL_ANIMATION_MOVE:
+    wlr_scene_node_set_position(
+        anim->node, anim->from_x + (int)((anim->to_x - anim->from_x) * t),
+        anim->from_y + (int)((anim->to_y - anim->from_y) * t));
+    spatial_update_toplevel(anim->toplevel);
+    break;
+  case TINYWL_ANIMATION_BORDER: {
+    float color[4];
+    for (int i = 0; i < 4; i++) {
+      color[i] = anim->from_color[i] +
+                 (float)((anim->to_color[i] - anim->from_color[i]) * t);
+    }
+    set_border_color(anim->toplevel, color);
+    break;
+  }
+  }
+}
+
+static void animation_destroy(struct tinywl_animation *anim) {
+  wl_list_remove(&anim->link);
+  wl_list_remove(&anim->node_destroy.link);
+  free(anim);
+}
+
+static void animation_finish(struct tinywl_animation *anim) {
+  animation_step(anim, 1.0);
+  if (anim->type == TINYWL_ANIMATION_MOVE) {
+    /* The pass run when the layout was applied saw the old position */
+    occlusion_schedule(anim->server);
+  }
+  struct tinywl_snapshot *snapshot = anim->snapshot;
+  animation_destroy(anim);
+  /* Destroying the snapshot's tree can't reach the animation anymore */
+  snapshot_destroy(snapshot);
+}
+
+static void animation_handle_node_destroy(struct wl_listener *listener,
+                                          void *data) {
+  (void)data; // data is unused here
+  struct tinywl_animation *anim =
+      wl_container_of(listener, anim, node_destroy);
+  if (anim->snapshot != NULL) {
+    /* The snapshot's tree is the node being destroyed */
+    free(anim->snapshot->buffers);
+    free(anim->snapshot);
+  }
+  animation_destroy(anim);
+}
+
+static struct tinywl_animation *animation_find(struct tinywl_server *server,
+                                               struct wlr_scene_node *node,
+                                               enum tinywl_animation_type type) {
+  struct tinywl_animation *anim;
+  wl_list_for_each(anim, &server->animations, link) {
+    if (anim->node == node && anim->type == type) {
+      return anim;
+    }
+  }
+  return NULL;
+}
+
+static struct tinywl_animation *
+animation_start(struct tinywl_server *server, struct wlr_scene_node *node,
+                enum tinywl_animation_type type) {
+  struct tinywl_animation *anim = animation_find(server, node, type);
+  if (anim == NULL) {
+    anim = calloc(1, sizeof(*anim));
+    anim->server = server;
+    anim->node = node;
+    anim->type = type;
+    anim->node_destroy.notify = animation_handle_node_destroy;
+    wl_signal_add(&node->events.destroy, &anim->node_destroy);
+    wl_list_insert(&server->animations, &anim->link);
+  }
+  anim->start_ns = monotonic_ns();
+
+  /* Idle outputs have to be woken up, see animation_frame() */
+  struct tinywl_output *output;
+  wl_list_for_each(output, &server->outputs, link) {
+    wlr_output_schedule_frame(output->wlr_output);
+  }
+  return anim;
+}
+
+void animation_fade_in(struct tinywl_server *server,
+                       struct wlr_scene_node *node) {
+  if (!animations_enabled(server)) {
+    return;
+  }
+  struct tinywl_animation *anim =
+      animation_start(server, node, TINYWL_ANIMATION_FADE_IN);
+  animation_step(anim, 0.0);
+}
+
+void animation_fade_out(struct tinywl_toplevel *toplevel) {
+  struct tinywl_server *server = toplevel->server;
+  struct tinywl_workspace *workspace = toplevel->workspace;
+  struct wlr_scene_node *node = &toplevel->scene_tree->node;
+  if (!animations_enabled(server) || workspace == NULL ||
+      workspace->output->active_workspace != workspace || !node->enabled) {
+    return;
+  }
+
+  /* Taken in the window's own layer, then moved to where the window is */
+  struct wlr_box *geo_box = &toplevel->xdg_toplevel->base->geometry;
+  struct tinywl_snapshot *snapshot =
+      snapshot_create(node->parent, &toplevel->content_tree->node,
+                      geo_box->width, geo_box->height);
+  wlr_scene_node_set_position(&snapshot->tree->node, node->x, node->y);
+  wlr_scene_node_place_above(&snapshot->tree->node, node);
+
+  struct tinywl_animation *anim = animation_start(
+      server, &snapshot->tree->node, TINYWL_ANIMATION_FADE_OUT);
+  anim->snapshot = snapshot;
+}
+
+void animation_move(struct tinywl_toplevel *toplevel, int x, int y) {
+  struct tinywl_server *server = toplevel->server;
+  struct wlr_scene_node *node = &toplevel->scene_tree->node;
+  struct tinywl_workspace *workspace = toplevel->workspace;
+  if (!animations_enabled(server) || (node->x == x && node->y == y) ||
+      workspace == NULL || workspace->output->active_workspace != workspace ||
+      !node->enabled) {
+    animation_finish_node(server, node);
+    wlr_scene_node_set_position(node, x, y);
+    spatial_update_toplevel(toplevel);
+    return;
+  }
+
+  struct tinywl_animation *anim =
+      animation_start(server, node, TINYWL_ANIMATION_MOVE);
+  anim->toplevel = toplevel;
+  anim->from_x = node->x;
+  anim->from_y = node->y;
+  anim->to_x = x;
+  anim->to_y = y;
+}
+
+void animation_border_color(struct tinywl_toplevel *toplevel,
+                            const float color[4]) {
+  struct tinywl_server *server = toplevel->server;
+  if (!animations_enabled(server)) {
+    set_border_color(toplevel, color);
+    return;
+  }
+
+  struct tinywl_animation *anim = animation_start(
+      server, &toplevel->scene_tree->node, TINYWL_ANIMATION_BORDER);
+  anim->toplevel = toplevel;
+  memcpy(anim->from_color, toplevel->border_top->color,
+         sizeof(anim->from_color));
+  memcpy(anim->to_color, color, sizeof(anim->to_color));
+}
+
+void animation_finish_node(struct tinywl_server *server,
+                           struct wlr_scene_node *node) {
+  struct tinywl_animation *anim, *tmp;
+  wl_list_for_each_safe(anim, tmp, &server->animations, link) {
+    if (anim->node == node) {
+      animation_finish(anim);
+    }
+  }
+}
+
+static void animation_finish_all(struct tinywl_server *server) {
+  struct tinywl_animation *anim, *tmp;
+  wl_list_for_each_safe(anim, tmp, &server->animations, link) {
+    animation_finish(anim);
+  }
+}
+
+bool animation_frame(struct tinywl_output *output) {
+  struct tinywl_server *server = output->server;
+  if (wl_list_empty(&server->animations)) {
+    return false;
+  }
+
+  uint64_t now = monotonic_ns();
+  uint64_t duration = (uint64_t)ANIMATION_DURATION_MS * 1000000;
+  struct tinywl_animation *anim, *tmp;
+  wl_list_for_each_safe(anim, tmp, &server->animations, link) {
+    uint64_t elapsed = now - anim->start_ns;
+    if (elapsed >= duration) {
+      animation_finish(anim);
+      continue;
+    }
+    /* Ease out, fast at first and settling gently */
+    double t = 1.0 - (double)elapsed / duration;
+    animation_step(anim, 1.0 - t * t * t);
+  }
+
+  if (!wl_list_empty(&server->animations)) {
+    wlr_output_schedule_frame(output->wlr_output);
+  }
+  return true;
+}
+
+void animation_report_frame(struct tinywl_server *server, uint64_t render_ns) {
+  if (render_ns <= (uint64_t)ANIMATION_FRAME_BUDGET_MS * 1000000) {
+    server->animation_slow_frames = 0;
+    return;
+  }
+  if (++server->animation_slow_frames < ANIMATION_SLOW_FRAMES) {
+    return;
+  }
+  wlr_log(WLR_INFO, "Frames take over %d ms to render, disabling animations",
+          ANIMATION_FRAME_BUDGET_MS);
+  server->animations_disabled = true;
+  animation_finish_all(server);
+}
@@ -1,9 +1,49 @@
 #include "config.h"
+#include "layout.h"
+#include "overview.h"
+#include "scratchpad.h"
+#include "switcher.h"
 #include "utils.h"
+#include "workspace.h"
 
 const compositor_binding c_bindings[C_BINDINGS_COUNT] = {{XKB_KEY_Escape, terminate_display},
                                           {XKB_KEY_F1, cycle_toplevel},
-                                          {XKB_KEY_q, close_focused_surface}};
+                                          {XKB_KEY_q, close_focused_surface},
+                                          {XKB_KEY_equal, grow_focused_toplevel},
+                                          {XKB_KEY_minus, shrink_focused_toplevel},
+                                          {XKB_KEY_space, toggle_floating_focused},
+                                          {XKB_KEY_Tab, switcher_next},
+                                          {XKB_KEY_ISO_Left_Tab, switcher_prev},
+                                          {XKB_KEY_o, overview_toggle},
+                                          {XKB_KEY_n, minimize_focused},
+                                          {XKB_KEY_N, restore_minimized},
+                                          {XKB_KEY_grave, scratchpad_toggle},
+                                          {XKB_KEY_asciitilde, scratchpad_move_focused},
+                                          {XKB_KEY_w, tab_focused_container},
+                                          {XKB_KEY_s, stack_focused_container},
+                                          {XKB_KEY_t, split_focused_container}};
+
+/* Alt+N shows workspace N, Alt+Shift+N moves the focused window there. With
+ * Shift held, the number row produces the shifted keysyms. */
+const workspace_binding ws_bindings[WS_BINDINGS_COUNT] = {
+    {XKB_KEY_1, switch_workspace, 0},
+    {XKB_KEY_2, switch_workspace, 1},
+    {XKB_KEY_3, switch_workspace, 2},
+    {XKB_KEY_4, switch_workspace, 3},
+    {XKB_KEY_5, switch_workspace, 4},
+    {XKB_KEY_6, switch_workspace, 5},
+    {XKB_KEY_7, switch_workspace, 6},
+    {XKB_KEY_8, switch_workspace, 7},
+    {XKB_KEY_9, switch_workspace, 8},
+    {XKB_KEY_exclam, move_focused_to_workspace, 0},
+    {XKB_KEY_at, move_focused_to_workspace, 1},
+    {XKB_KEY_numbersign, move_focused_to_workspace, 2},
+    {XKB_KEY_dollar, move_focused_to_workspace, 3},
+    {XKB_KEY_percent, move_focused_to_workspace, 4},
+    {XKB_KEY_asciicircum, move_focused_to_workspace, 5},
+    {XKB_KEY_ampersand, move_focused_to_workspace, 6},
+    {XKB_KEY_asterisk, move_focused_to_workspace, 7},
+    {XKB_KEY_parenleft, move_focused_to_workspace, 8}};
 
 const user_binding bindings[BINDINGS_COUNT] = {
     {XKB_KEY_Return, "kitty"},
@@ -21,10 +61,24 @@ const user_binding bindings[BINDINGS_COUNT] = {
     {XKB_KEY_XF86AudioLowerVolume, "pactl set-sink-volume @DEFAULT_SINK@ -10%"},
     {XKB_KEY_XF86AudioMute, "pactl set-sink-mute @DEFAULT_SINK@ toggle"}};
 
+/* Every matching rule applies, later ones override earlier ones */
+const window_rule rules[RULES_COUNT] = {
+    {.app_id = "pavucontrol", .floating = RULE_YES, .width = 800, .height = 500},
+    {.app_id = "mpv", .throttle = RULE_NO},
+    {.title = "^Picture-in-Picture$", .floating = RULE_YES, .border = RULE_NO}};
+
 const compositor_binding *get_c_bindings(void) {
     return c_bindings;
 }
 
+const workspace_binding *get_ws_bindings(void) {
+    return ws_bindings;
+}
+
+const window_rule *get_rules(void) {
+    return rules;
+}
+
 const user_binding *get_bindings(void) {
     return bindings;
 }
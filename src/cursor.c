@@ -1,20 +1,191 @@
 #include "cursor.h"
+#include "animation.h"
+#include "config.h"
+#include "layout.h"
+#include "occlusion.h"
+#include "output.h"
+#include "overview.h"
 #include "server.h"
+#include "snap.h"
+#include "snapshot.h"
+#include "spatial.h"
 #include "toplevel.h"
+#include "transaction.h"
 #include "utils.h"
 
+void cursor_apply_move(struct tinywl_server *server) {
+  if (!server->move_pending) {
+    return;
+  }
+  server->move_pending = false;
+  wlr_scene_node_set_position(&server->grabbed_toplevel->scene_tree->node,
+                              server->move_x, server->move_y);
+  spatial_update_toplevel(server->grabbed_toplevel);
+  occlusion_schedule(server);
+}
+
+void cursor_focus_frame(struct tinywl_server *server) {
+  if (!server->focus_pending ||
+      monotonic_ns() - server->focus_candidate_ns <
+          (uint64_t)FOCUS_DWELL_MS * 1000000) {
+    return;
+  }
+  server->focus_pending = false;
+  /* Leave focus alone while the keyboard or a grab is driving it. Popup
+   * menus hold a seat grab, moving focus would dismiss them. */
+  if (server->cursor_mode != TINYWL_CURSOR_PASSTHROUGH ||
+      wlr_seat_pointer_has_grab(server->seat) ||
+      wlr_seat_keyboard_has_grab(server->seat) ||
+      server->switcher_selected != NULL || server->overview != NULL ||
+      server->focus_candidate->workspace == NULL) {
+    return;
+  }
+  focus_toplevel(server->focus_candidate);
+}
+
+int cursor_focus_timeout(void *data) {
+  struct tinywl_server *server = data;
+  struct tinywl_output *output =
+      output_at(server, server->cursor->x, server->cursor->y);
+  if (output != NULL) {
+    wlr_output_schedule_frame(output->wlr_output);
+  } else {
+    cursor_focus_frame(server);
+  }
+  return 0;
+}
+
+static void update_focus_candidate(struct tinywl_server *server,
+                                   struct tinywl_toplevel *toplevel) {
+  if (toplevel == server->focus_candidate) {
+    return;
+  }
+  server->focus_candidate = toplevel;
+  server->focus_candidate_ns = monotonic_ns();
+  server->focus_pending = toplevel != NULL;
+  wl_event_source_timer_update(server->focus_timer,
+                               toplevel != NULL ? FOCUS_DWELL_MS : 0);
+}
+
+static void resize_drop_snapshot(struct tinywl_toplevel *toplevel) {
+  snapshot_destroy(toplevel->resize_snapshot);
+  toplevel->resize_snapshot = NULL;
+  wlr_scene_node_set_enabled(&toplevel->content_tree->node, true);
+
+  /* The client may have picked another size than asked for, keep the edges
+   * that aren't being dragged where they were */
+  struct wlr_box *box = &toplevel->resize_box;
+  struct wlr_box *geo_box = &toplevel->xdg_toplevel->base->geometry;
+  int x = box->x, y = box->y;
+  if (toplevel->resize_edges & WLR_EDGE_LEFT) {
+    x = box->x + box->width - geo_box->width;
+  }
+  if (toplevel->resize_edges & WLR_EDGE_TOP) {
+    y = box->y + box->height - geo_box->height;
+  }
+  wlr_scene_node_set_position(&toplevel->scene_tree->node, x, y);
+  toplevel_update_borders(toplevel);
+  spatial_update_toplevel(toplevel);
+}
+
+static void resize_send_queued(struct tinywl_toplevel *toplevel) {
+  toplevel->resize_box = toplevel->resize_queued_box;
+  toplevel->resize_queued = false;
+  toplevel->resize_serial = wlr_xdg_toplevel_set_size(
+      toplevel->xdg_toplevel, toplevel->resize_box.width,
+      toplevel->resize_box.height);
+  if (toplevel->resize_snapshot != NULL) {
+    wl_event_source_timer_update(toplevel->server->resize_timer,
+                                 TRANSACTION_TIMEOUT_MS);
+  }
+}
+
 void reset_cursor_mode(struct tinywl_server *server) {
+  /* Land the window exactly where the pointer left it */
+  cursor_apply_move(server);
+  snap_index_destroy(server->snap_index);
+  server->snap_index = NULL;
+
+  /* Show the live window again, the client gets the last size right away */
+  struct tinywl_toplevel *toplevel = server->grabbed_toplevel;
+  if (server->cursor_mode == TINYWL_CURSOR_RESIZE && toplevel != NULL) {
+    if (toplevel->resize_snapshot != NULL) {
+      resize_drop_snapshot(toplevel);
+    }
+    if (toplevel->resize_queued) {
+      resize_send_queued(toplevel);
+    }
+  }
+  wl_event_source_timer_update(server->resize_timer, 0);
+
   /* Reset the cursor mode to passthrough. */
   server->cursor_mode = TINYWL_CURSOR_PASSTHROUGH;
   server->grabbed_toplevel = NULL;
 }
 
 void process_cursor_move(struct tinywl_server *server) {
-  /* Move the grabbed toplevel to the new position. */
+  /* Only remember where the grabbed toplevel should go, it's moved when the
+   * next frame is rendered. Snapping works on the box including borders. */
   struct tinywl_toplevel *toplevel = server->grabbed_toplevel;
-  wlr_scene_node_set_position(&toplevel->scene_tree->node,
-                              server->cursor->x - server->grab_x,
-                              server->cursor->y - server->grab_y);
+  struct wlr_box *geo_box = &toplevel->xdg_toplevel->base->geometry;
+  struct wlr_box box = {
+      .x = (int)(server->cursor->x - server->grab_x) - BORDER_WIDTH,
+      .y = (int)(server->cursor->y - server->grab_y) - BORDER_WIDTH,
+      .width = geo_box->width + 2 * BORDER_WIDTH,
+      .height = geo_box->height + 2 * BORDER_WIDTH,
+  };
+  snap_box(server->snap_index, &box);
+  server->move_x = box.x + BORDER_WIDTH;
+  server->move_y = box.y + BORDER_WIDTH;
+  server->move_pending = true;
+
+  struct tinywl_output *output =
+      output_at(server, server->cursor->x, server->cursor->y);
+  if (output != NULL) {
+    wlr_output_schedule_frame(output->wlr_output);
+  }
+}
+
+static void resize_take_snapshot(struct tinywl_toplevel *toplevel) {
+  /* Freeze what the client last drew and hide the live content behind it */
+  struct wlr_box *geo_box = &toplevel->xdg_toplevel->base->geometry;
+  snapshot_destroy(toplevel->resize_snapshot);
+  wlr_scene_node_set_enabled(&toplevel->content_tree->node, true);
+  toplevel->resize_snapshot =
+      snapshot_create(toplevel->scene_tree, &toplevel->content_tree->node,
+                      geo_box->width, geo_box->height);
+  wlr_scene_node_set_enabled(&toplevel->content_tree->node, false);
+}
+
+static void resize_show_snapshot(struct tinywl_toplevel *toplevel,
+                                 const struct wlr_box *box) {
+  wlr_scene_node_set_position(&toplevel->scene_tree->node, box->x, box->y);
+  snapshot_scale(toplevel->resize_snapshot, box->width, box->height);
+  spatial_update_toplevel(toplevel);
+  toplevel_update_borders(toplevel);
+}
+
+int cursor_resize_timeout(void *data) {
+  struct tinywl_server *server = data;
+  struct tinywl_toplevel *toplevel = server->grabbed_toplevel;
+  if (toplevel == NULL || toplevel->resize_snapshot == NULL) {
+    return 0;
+  }
+  /* The client is too slow, show what it drew so far and stop waiting. The
+   * next motion sends the queued size with a new snapshot. */
+  toplevel->resize_serial = 0;
+  resize_drop_snapshot(toplevel);
+  return 0;
+}
+
+void cursor_resize_frame(struct tinywl_output *output,
+                         const struct timespec *when) {
+  /* The hidden content gets no frame callbacks from the scene */
+  struct tinywl_toplevel *toplevel = output->server->grabbed_toplevel;
+  if (toplevel != NULL && toplevel->resize_snapshot != NULL &&
+      toplevel->workspace != NULL && toplevel->workspace->output == output) {
+    toplevel_send_frame_done(toplevel, when);
+  }
 }
 
 void process_cursor_resize(struct tinywl_server *server) {
@@ -24,9 +195,9 @@ void process_cursor_resize(struct tinywl_server *server) {
    * toplevel on one or two axes, but can also move the toplevel if you resize
    * from the top or left edges (or top-left corner).
    *
-   * Note that some shortcuts are taken here. In a more fleshed-out
-   * compositor, you'd wait for the client to prepare a buffer at the new
-   * size, then commit any movement that was prepared.
+   * Until the client has drawn itself at the new size, a snapshot of its
+   * last frame is shown stretched to the new size instead, so the window
+   * follows the pointer at display rate. See cursor_resize_notify_commit().
    */
   struct tinywl_toplevel *toplevel = server->grabbed_toplevel;
   double border_x = server->cursor->x - server->grab_x;
@@ -59,13 +230,46 @@ void process_cursor_resize(struct tinywl_server *server) {
     }
   }
 
-  struct wlr_box *geo_box = &toplevel->xdg_toplevel->base->geometry;
-  wlr_scene_node_set_position(&toplevel->scene_tree->node,
-                              new_left - geo_box->x, new_top - geo_box->y);
+  toplevel->resize_queued_box = (struct wlr_box){
+      .x = new_left,
+      .y = new_top,
+      .width = new_right - new_left,
+      .height = new_bottom - new_top,
+  };
+  toplevel->resize_edges = server->resize_edges;
+  toplevel->resize_queued = true;
+  if (toplevel->resize_serial == 0) {
+    if (toplevel->resize_snapshot == NULL) {
+      resize_take_snapshot(toplevel);
+    }
+    resize_send_queued(toplevel);
+  }
+  resize_show_snapshot(toplevel, &toplevel->resize_queued_box);
+}
 
-  int new_width = new_right - new_left;
-  int new_height = new_bottom - new_top;
-  wlr_xdg_toplevel_set_size(toplevel->xdg_toplevel, new_width, new_height);
+void cursor_resize_notify_commit(struct tinywl_toplevel *toplevel) {
+  if (toplevel->resize_serial == 0) {
+    return;
+  }
+  /* Serials wrap around, compare them as a signed difference */
+  uint32_t acked = toplevel->xdg_toplevel->base->current.configure_serial;
+  if ((int32_t)(acked - toplevel->resize_serial) < 0) {
+    return;
+  }
+  toplevel->resize_serial = 0;
+
+  if (toplevel->resize_queued) {
+    /* The pointer moved on in the meantime. Keep stretching a snapshot, but
+     * of the frame the client just drew, it's the closest to the new size. */
+    resize_take_snapshot(toplevel);
+    resize_show_snapshot(toplevel, &toplevel->resize_queued_box);
+    resize_send_queued(toplevel);
+    return;
+  }
+
+  /* The client caught up, show it again */
+  wl_event_source_timer_update(toplevel->server->resize_timer, 0);
+  resize_drop_snapshot(toplevel);
 }
 
 void process_cursor_motion(struct tinywl_server *server, uint32_t time) {
@@ -77,6 +281,10 @@ void process_cursor_motion(struct tinywl_server *server, uint32_t time) {
     process_cursor_resize(server);
     return;
   }
+  if (server->overview != NULL) {
+    overview_pointer_motion(server);
+    return;
+  }
 
   /* Otherwise, find the toplevel under the pointer and send the event along. */
   double sx, sy;
@@ -84,11 +292,15 @@ void process_cursor_motion(struct tinywl_server *server, uint32_t time) {
   struct wlr_surface *surface = NULL;
   struct tinywl_toplevel *toplevel = desktop_toplevel_at(
       server, server->cursor->x, server->cursor->y, &surface, &sx, &sy);
-  if (!toplevel) {
+  if (!toplevel && !server->cursor_default) {
     /* If there's no toplevel under the cursor, set the cursor image to a
      * default. This is what makes the cursor image appear when you move it
      * around the screen, not over any toplevels. */
     wlr_cursor_set_xcursor(server->cursor, server->cursor_mgr, "default");
+    server->cursor_default = true;
+  }
+  if (FOCUS_FOLLOWS_MOUSE) {
+    update_focus_candidate(server, toplevel);
   }
   if (surface) {
     /*
@@ -98,11 +310,12 @@ void process_cursor_motion(struct tinywl_server *server, uint32_t time) {
      * from keyboard focus. You get pointer focus by moving the pointer over
      * a window.
      *
-     * Note that wlroots will avoid sending duplicate enter/motion events if
-     * the surface has already has pointer focus or if the client is already
-     * aware of the coordinates passed.
+     * Most motion stays on the surface that already has pointer focus, it
+     * only needs the motion event.
      */
-    wlr_seat_pointer_notify_enter(seat, surface, sx, sy);
+    if (seat->pointer_state.focused_surface != surface) {
+      wlr_seat_pointer_notify_enter(seat, surface, sx, sy);
+    }
     wlr_seat_pointer_notify_motion(seat, time, sx, sy);
   } else {
     /* Clear pointer focus so future button events and such are not sent to
@@ -149,6 +362,13 @@ void server_cursor_button(struct wl_listener *listener, void *data) {
   struct tinywl_server *server =
       wl_container_of(listener, server, cursor_button);
   struct wlr_pointer_button_event *event = data;
+  if (server->overview != NULL) {
+    /* Clicks pick a window in the overview, clients don't see them */
+    if (event->state == WL_POINTER_BUTTON_STATE_PRESSED) {
+      overview_pointer_button(server);
+    }
+    return;
+  }
   /* Notify the client with pointer focus that a button press has occurred */
   wlr_seat_pointer_notify_button(server->seat, event->time_msec, event->button,
                                  event->state);
@@ -161,6 +381,10 @@ void server_cursor_button(struct wl_listener *listener, void *data) {
     struct wlr_surface *surface = NULL;
     struct tinywl_toplevel *toplevel = desktop_toplevel_at(
         server, server->cursor->x, server->cursor->y, &surface, &sx, &sy);
+    if (toplevel == NULL) {
+      /* Clicking a tab focuses the window behind it */
+      toplevel = layout_tab_at(server, server->cursor->x, server->cursor->y);
+    }
     focus_toplevel(toplevel);
   }
 }
@@ -195,26 +419,40 @@ void begin_interactive(struct tinywl_toplevel *toplevel,
    * consumes them itself, to move or resize windows. */
   struct tinywl_server *server = toplevel->server;
 
+  /* Tiled and maximized windows are placed by the compositor, not by the
+   * pointer */
+  if (toplevel->container != NULL || toplevel->maximized) {
+    return;
+  }
+
+  /* The grab places the window itself from now on */
+  animation_finish_node(server, &toplevel->scene_tree->node);
+  animation_finish_node(server, &toplevel->content_tree->node);
   server->grabbed_toplevel = toplevel;
   server->cursor_mode = mode;
 
   if (mode == TINYWL_CURSOR_MOVE) {
     server->grab_x = server->cursor->x - toplevel->scene_tree->node.x;
     server->grab_y = server->cursor->y - toplevel->scene_tree->node.y;
+    server->snap_index = snap_index_create(server, toplevel);
   } else {
     struct wlr_box *geo_box = &toplevel->xdg_toplevel->base->geometry;
 
-    double border_x = (toplevel->scene_tree->node.x + geo_box->x) +
+    /* The scene tree sits at the geometry origin, see toplevel.h */
+    double border_x = toplevel->scene_tree->node.x +
                       ((edges & WLR_EDGE_RIGHT) ? geo_box->width : 0);
-    double border_y = (toplevel->scene_tree->node.y + geo_box->y) +
+    double border_y = toplevel->scene_tree->node.y +
                       ((edges & WLR_EDGE_BOTTOM) ? geo_box->height : 0);
     server->grab_x = server->cursor->x - border_x;
     server->grab_y = server->cursor->y - border_y;
 
     server->grab_geobox = *geo_box;
-    server->grab_geobox.x += toplevel->scene_tree->node.x;
-    server->grab_geobox.y += toplevel->scene_tree->node.y;
+    server->grab_geobox.x = toplevel->scene_tree->node.x;
+    server->grab_geobox.y = toplevel->scene_tree->node.y;
 
     server->resize_edges = edges;
+    /* Answers to an earlier resize don't matter to this one */
+    toplevel->resize_serial = 0;
+    toplevel->resize_queued = false;
   }
 }
@@ -0,0 +1,79 @@
+#include "decoration.h"
+#include "config.h"
+#include "rules.h"
+#include "toplevel.h"
+
+static enum wlr_xdg_toplevel_decoration_v1_mode
+decoration_mode(struct tinywl_toplevel *toplevel) {
+  struct wlr_xdg_toplevel *xdg_toplevel = toplevel->xdg_toplevel;
+  struct tinywl_rule_result rule;
+  rules_match(toplevel->server, xdg_toplevel->app_id, xdg_toplevel->title,
+              &rule);
+  if (rule.client_decorations != RULE_UNSET) {
+    return rule.client_decorations == RULE_YES
+               ? WLR_XDG_TOPLEVEL_DECORATION_V1_MODE_CLIENT_SIDE
+               : WLR_XDG_TOPLEVEL_DECORATION_V1_MODE_SERVER_SIDE;
+  }
+  if (SERVER_SIDE_DECORATIONS) {
+    return WLR_XDG_TOPLEVEL_DECORATION_V1_MODE_SERVER_SIDE;
+  }
+  /* Up to the client, which is also what no preference means */
+  enum wlr_xdg_toplevel_decoration_v1_mode requested =
+      toplevel->decoration->requested_mode;
+  return requested != WLR_XDG_TOPLEVEL_DECORATION_V1_MODE_NONE
+             ? requested
+             : WLR_XDG_TOPLEVEL_DECORATION_V1_MODE_CLIENT_SIDE;
+}
+
+void decoration_update(struct tinywl_toplevel *toplevel) {
+  /* The mode can only be sent once the surface has been initialized */
+  if (toplevel->decoration == NULL ||
+      !toplevel->xdg_toplevel->base->initialized) {
+    return;
+  }
+  wlr_xdg_toplevel_decoration_v1_set_mode(toplevel->decoration,
+                                          decoration_mode(toplevel));
+}
+
+static void decoration_request_mode(struct wl_listener *listener,
+                                    void *data) {
+  (void)data; // data is unused here
+  struct tinywl_toplevel *toplevel =
+      wl_container_of(listener, toplevel, decoration_request_mode);
+  decoration_update(toplevel);
+}
+
+void decoration_finish(struct tinywl_toplevel *toplevel) {
+  if (toplevel->decoration == NULL) {
+    return;
+  }
+  wl_list_remove(&toplevel->decoration_request_mode.link);
+  wl_list_remove(&toplevel->decoration_destroy.link);
+  toplevel->decoration = NULL;
+}
+
+static void decoration_destroy(struct wl_listener *listener, void *data) {
+  (void)data; // data is unused here
+  struct tinywl_toplevel *toplevel =
+      wl_container_of(listener, toplevel, decoration_destroy);
+  decoration_finish(toplevel);
+}
+
+void server_new_toplevel_decoration(struct wl_listener *listener, void *data) {
+  (void)listener; // unused here
+  struct wlr_xdg_toplevel_decoration_v1 *decoration = data;
+
+  /* The xdg_surface's data is the window's content tree, whose parent is the
+   * window's scene tree, see server_new_xdg_toplevel() */
+  struct wlr_scene_tree *content_tree = decoration->toplevel->base->data;
+  struct tinywl_toplevel *toplevel = content_tree->node.parent->node.data;
+  toplevel->decoration = decoration;
+
+  toplevel->decoration_request_mode.notify = decoration_request_mode;
+  wl_signal_add(&decoration->events.request_mode,
+                &toplevel->decoration_request_mode);
+  toplevel->decoration_destroy.notify = decoration_destroy;
+  wl_signal_add(&decoration->events.destroy, &toplevel->decoration_destroy);
+
+  decoration_update(toplevel);
+}
@@ -2,6 +2,8 @@
 
 #include "keyboard.h"
 #include "config.h"
+#include "overview.h"
+#include "switcher.h"
 #include "utils.h"
 
 /**
@@ -30,6 +32,24 @@ static void keyboard_handle_modifiers(struct wl_listener *listener,
   /* Send modifiers to the client. */
   wlr_seat_keyboard_notify_modifiers(keyboard->server->seat,
                                      &keyboard->wlr_keyboard->modifiers);
+
+  /* Releasing the modifier ends a window switch */
+  if (!(wlr_keyboard_get_modifiers(keyboard->wlr_keyboard) & MODKEY)) {
+    switcher_commit(keyboard->server);
+  }
+}
+
+static bool handle_overview_binding(struct tinywl_server *server,
+                                    xkb_keysym_t sym) {
+  /* Only the binding that toggles the overview works while it is open */
+  const compositor_binding *c_bindings = get_c_bindings();
+  for (unsigned int i = 0; i < C_BINDINGS_COUNT; i++) {
+    if (c_bindings[i].key == sym && c_bindings[i].fptr == overview_toggle) {
+      overview_toggle(server);
+      return true;
+    }
+  }
+  return false;
 }
 
 static bool handle_keybinding(struct tinywl_server *server, xkb_keysym_t sym) {
@@ -51,7 +71,7 @@ static bool handle_keybinding(struct tinywl_server *server, xkb_keysym_t sym) {
   }
 
   const compositor_binding *c_bindings = get_c_bindings();
-  for (unsigned int i = 0; i < 3; i++) {
+  for (unsigned int i = 0; i < C_BINDINGS_COUNT; i++) {
     if (c_bindings[i].key == sym) {
       match_found = true;
       c_bindings[i].fptr(server);
@@ -59,6 +79,15 @@ static bool handle_keybinding(struct tinywl_server *server, xkb_keysym_t sym) {
     }
   }
 
+  const workspace_binding *ws_bindings = get_ws_bindings();
+  for (unsigned int i = 0; i < WS_BINDINGS_COUNT; i++) {
+    if (ws_bindings[i].key == sym) {
+      match_found = true;
+      ws_bindings[i].fptr(server, ws_bindings[i].index);
+      break;
+    }
+  }
+
   return match_found;
 }
 
@@ -76,6 +105,20 @@ static void keyboard_handle_key(struct wl_listener *listener, void *data) {
   int nsyms =
       xkb_state_key_get_syms(keyboard->wlr_keyboard->xkb_state, keycode, &syms);
 
+  if (server->overview != NULL) {
+    /* The overview takes every key while it is open */
+    if (event->state == WL_KEYBOARD_KEY_STATE_PRESSED) {
+      bool modkey =
+          wlr_keyboard_get_modifiers(keyboard->wlr_keyboard) & MODKEY;
+      for (int i = 0; i < nsyms; i++) {
+        if (!modkey || !handle_overview_binding(server, syms[i])) {
+          overview_handle_key(server, syms[i]);
+        }
+      }
+    }
+    return;
+  }
+
   bool handled = false;
   uint32_t modifiers = wlr_keyboard_get_modifiers(keyboard->wlr_keyboard);
   if ((modifiers & MODKEY) && event->state == WL_KEYBOARD_KEY_STATE_PRESSED) {
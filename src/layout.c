@@ -0,0 +1,636 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+#include "layout.h"
+#include "occlusion.h"
+#include "output.h"
+#include "toplevel.h"
+#include "transaction.h"
+#include "utils.h"
+#include "workspace.h"
+
+/* Smallest weight a window can be shrunk to */
+#define MIN_WEIGHT 0.1
+
+static struct tinywl_container *container_create(void) {
+  struct tinywl_container *container = calloc(1, sizeof(*container));
+  wl_list_init(&container->children);
+  wl_list_init(&container->link);
+  container->weight = 1.0;
+  return container;
+}
+
+static void container_destroy(struct tinywl_container *container) {
+  if (container->tab_tree != NULL) {
+    wlr_scene_node_destroy(&container->tab_tree->node);
+  }
+  free(container->placeholder);
+  free(container);
+}
+
+static bool is_tabbed(const struct tinywl_container *container) {
+  return container->layout == TINYWL_LAYOUT_TABBED ||
+         container->layout == TINYWL_LAYOUT_STACKED;
+}
+
+static int tab_bar_height(const struct tinywl_container *container) {
+  if (container->layout == TINYWL_LAYOUT_TABBED) {
+    return TAB_HEIGHT;
+  }
+  return TAB_HEIGHT * wl_list_length(&container->children);
+}
+
+static struct tinywl_workspace *
+container_workspace(struct tinywl_container *container) {
+  while (container->parent != NULL) {
+    container = container->parent;
+  }
+  return container->workspace;
+}
+
+static void tab_box(const struct tinywl_container *container, int index,
+                    int count, struct wlr_box *box) {
+  /* Tabs share one row, stacked titles get a row each */
+  *box = container->box;
+  box->height = TAB_HEIGHT;
+  if (container->layout == TINYWL_LAYOUT_TABBED) {
+    box->x += container->box.width * index / count;
+    box->width = container->box.width * (index + 1) / count -
+                 container->box.width * index / count;
+  } else {
+    box->y += TAB_HEIGHT * index;
+  }
+}
+
+static void update_tab_bar(struct tinywl_container *container) {
+  if (!is_tabbed(container)) {
+    if (container->tab_tree != NULL) {
+      wlr_scene_node_destroy(&container->tab_tree->node);
+      container->tab_tree = NULL;
+    }
+    return;
+  }
+  if (container->tab_tree == NULL) {
+    struct tinywl_workspace *workspace = container_workspace(container);
+    if (workspace == NULL) {
+      return;
+    }
+    container->tab_tree = wlr_scene_tree_create(workspace->tiled_tree);
+  }
+
+  /* A handful of rects, simply rebuilt whenever something changed */
+  struct wlr_scene_node *node, *tmp;
+  wl_list_for_each_safe(node, tmp, &container->tab_tree->children, link) {
+    wlr_scene_node_destroy(node);
+  }
+  static const float active_color[4] = TAB_COLOR_ACTIVE;
+  static const float inactive_color[4] = TAB_COLOR_INACTIVE;
+  int count = wl_list_length(&container->children), index = 0;
+  struct tinywl_container *child;
+  wl_list_for_each(child, &container->children, link) {
+    struct wlr_box box;
+    tab_box(container, index++, count, &box);
+    /* One pixel apart, so neighboring tabs can be told apart */
+    struct wlr_scene_rect *rect = wlr_scene_rect_create(
+        container->tab_tree, box.width > 1 ? box.width - 1 : 1,
+        box.height > 1 ? box.height - 1 : 1,
+        child == container->active ? active_color : inactive_color);
+    wlr_scene_node_set_position(&rect->node, box.x, box.y);
+  }
+}
+
+static void set_visible(struct tinywl_container *container, bool visible) {
+  struct tinywl_toplevel *toplevel = container->toplevel;
+  if (toplevel != NULL) {
+    if (toplevel->tab_hidden == !visible) {
+      return;
+    }
+    toplevel->tab_hidden = !visible;
+    /* Windows waiting for their first tile are shown by the transaction */
+    if (!toplevel->awaiting_placement) {
+      wlr_scene_node_set_enabled(&toplevel->scene_tree->node, visible);
+    }
+    occlusion_schedule(toplevel->server);
+    return;
+  }
+
+  bool tabbed = is_tabbed(container);
+  struct tinywl_container *child;
+  wl_list_for_each(child, &container->children, link) {
+    set_visible(child, visible && (!tabbed || child == container->active));
+  }
+}
+
+static bool container_visible(struct tinywl_container *container) {
+  for (; container->parent != NULL; container = container->parent) {
+    if (is_tabbed(container->parent) &&
+        container->parent->active != container) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void refresh_visibility(struct tinywl_container *container) {
+  set_visible(container, container_visible(container));
+}
+
+static void arrange(struct tinywl_container *container,
+                    const struct wlr_box *box, bool force) {
+  /* A container whose box didn't change has an unchanged subtree, unless
+   * its own children changed, which is what force is for. */
+  if (!force && wlr_box_equal(&container->box, box)) {
+    return;
+  }
+  container->box = *box;
+
+  if (container->toplevel != NULL) {
+    toplevel_set_tile(container->toplevel, box);
+    return;
+  }
+
+  struct tinywl_container *child;
+  if (is_tabbed(container)) {
+    /* Every child gets the whole area below the tab bar, switching tabs
+     * then never resizes anything */
+    int bar = tab_bar_height(container);
+    struct wlr_box child_box = *box;
+    child_box.y += bar;
+    child_box.height -= bar;
+    wl_list_for_each(child, &container->children, link) {
+      arrange(child, &child_box, false);
+    }
+    update_tab_bar(container);
+    return;
+  }
+  update_tab_bar(container);
+
+  double total = 0;
+  wl_list_for_each(child, &container->children, link) {
+    total += child->weight;
+  }
+
+  bool horizontal = container->layout == TINYWL_LAYOUT_SPLIT_H;
+  int length = horizontal ? box->width : box->height;
+  int offset = 0;
+  wl_list_for_each(child, &container->children, link) {
+    /* The last child takes whatever rounding left over */
+    int size = child->link.next == &container->children
+                   ? length - offset
+                   : (int)(length * child->weight / total + 0.5);
+    struct wlr_box child_box = *box;
+    if (horizontal) {
+      child_box.x += offset;
+      child_box.width = size;
+    } else {
+      child_box.y += offset;
+      child_box.height = size;
+    }
+    arrange(child, &child_box, false);
+    offset += size;
+  }
+}
+
+static struct tinywl_container *insertion_target(struct tinywl_container *root,
+                                                 struct tinywl_toplevel *skip) {
+  /* server->toplevels is kept in focus order, so the first tiled window of
+   * this tree is the one that was focused most recently. */
+  struct tinywl_server *server = root->workspace->output->server;
+  struct tinywl_toplevel *toplevel;
+  wl_list_for_each(toplevel, &server->toplevels, link) {
+    if (toplevel != skip && toplevel->container != NULL &&
+        toplevel->workspace == root->workspace) {
+      return toplevel->container;
+    }
+  }
+  return NULL;
+}
+
+struct tinywl_container *
+layout_root_create(struct tinywl_workspace *workspace) {
+  struct tinywl_container *root = container_create();
+  root->workspace = workspace;
+  return root;
+}
+
+void layout_root_destroy(struct tinywl_container *root) {
+  assert(wl_list_empty(&root->children));
+  container_destroy(root);
+}
+
+void layout_set_root_box(struct tinywl_container *root,
+                         const struct wlr_box *box) {
+  if (!is_tabbed(root)) {
+    root->layout = box->width >= box->height ? TINYWL_LAYOUT_SPLIT_H
+                                             : TINYWL_LAYOUT_SPLIT_V;
+  }
+  arrange(root, box, false);
+  transaction_commit(root->workspace->output->server);
+}
+
+void layout_insert(struct tinywl_container *root,
+                   struct tinywl_toplevel *toplevel) {
+  struct tinywl_container *leaf = container_create();
+  leaf->toplevel = toplevel;
+  toplevel->container = leaf;
+
+  struct tinywl_container *target = insertion_target(root, toplevel);
+  struct tinywl_container *changed;
+  if (target == NULL) {
+    /* First window on this workspace */
+    leaf->parent = root;
+    wl_list_insert(root->children.prev, &leaf->link);
+    root->active = leaf;
+    changed = root;
+  } else if (is_tabbed(target->parent)) {
+    /* A new tab next to the target, shown right away */
+    leaf->parent = target->parent;
+    wl_list_insert(&target->link, &leaf->link);
+    target->parent->active = leaf;
+    changed = target->parent;
+  } else {
+    enum tinywl_container_layout wanted =
+        target->box.width >= target->box.height ? TINYWL_LAYOUT_SPLIT_H
+                                                : TINYWL_LAYOUT_SPLIT_V;
+    struct tinywl_container *parent = target->parent;
+    if (parent->layout == wanted ||
+        wl_list_length(&parent->children) == 1) {
+      parent->layout = wanted;
+      leaf->parent = parent;
+      wl_list_insert(&target->link, &leaf->link);
+      changed = parent;
+    } else {
+      /* Replace the target with a split holding the target and the new
+       * window, the split inherits the target's place and share. */
+      struct tinywl_container *split = container_create();
+      split->layout = wanted;
+      split->parent = parent;
+      split->weight = target->weight;
+      split->box = target->box;
+      wl_list_insert(&target->link, &split->link);
+      wl_list_remove(&target->link);
+
+      target->parent = split;
+      target->weight = 1.0;
+      wl_list_insert(split->children.prev, &target->link);
+      leaf->parent = split;
+      wl_list_insert(split->children.prev, &leaf->link);
+      changed = split;
+    }
+  }
+
+  arrange(changed, &changed->box, true);
+  refresh_visibility(changed);
+  transaction_commit(toplevel->server);
+}
+
+static struct tinywl_container *detach(struct tinywl_container *leaf) {
+  struct tinywl_container *parent = leaf->parent;
+  if (parent->active == leaf) {
+    /* The neighboring tab takes over, the previous one if it was last */
+    struct wl_list *next = leaf->link.next != &parent->children
+                               ? leaf->link.next
+                               : leaf->link.prev;
+    parent->active = next != &parent->children
+                         ? wl_container_of(next, parent->active, link)
+                         : NULL;
+  }
+  wl_list_remove(&leaf->link);
+  container_destroy(leaf);
+
+  if (parent->parent != NULL && wl_list_length(&parent->children) == 1) {
+    /* Collapse the split, its only child takes its place */
+    struct tinywl_container *child =
+        wl_container_of(parent->children.next, child, link);
+    struct tinywl_container *grandparent = parent->parent;
+    child->parent = grandparent;
+    child->weight = parent->weight;
+    wl_list_remove(&child->link);
+    wl_list_insert(&parent->link, &child->link);
+    wl_list_remove(&parent->link);
+    if (grandparent->active == parent) {
+      grandparent->active = child;
+    }
+    container_destroy(parent);
+    parent = grandparent;
+  }
+  /* The container whose children changed */
+  return parent;
+}
+
+void layout_remove(struct tinywl_toplevel *toplevel) {
+  struct tinywl_container *leaf = toplevel->container;
+  if (leaf == NULL) {
+    return;
+  }
+  set_visible(leaf, true);
+  toplevel->container = NULL;
+  struct tinywl_container *parent = detach(leaf);
+
+  arrange(parent, &parent->box, true);
+  refresh_visibility(parent);
+  transaction_commit(toplevel->server);
+}
+
+void layout_resize(struct tinywl_toplevel *toplevel, double delta) {
+  struct tinywl_container *container = toplevel->container;
+  if (container == NULL) {
+    return;
+  }
+  container->weight += delta;
+  if (container->weight < MIN_WEIGHT) {
+    container->weight = MIN_WEIGHT;
+  }
+  arrange(container->parent, &container->parent->box, true);
+  transaction_commit(toplevel->server);
+}
+
+static struct tinywl_container *save_subtree(struct tinywl_container *container) {
+  struct tinywl_container *copy = container_create();
+  copy->layout = container->layout;
+  copy->weight = container->weight;
+
+  struct tinywl_toplevel *toplevel = container->toplevel;
+  if (toplevel != NULL) {
+    /* A window that was already moved here from another output that went
+     * away keeps its place there, this leaf stays empty */
+    if (toplevel->home == NULL) {
+      copy->toplevel = toplevel;
+      toplevel->home_leaf = copy;
+    }
+    return copy;
+  }
+
+  struct tinywl_container *child;
+  wl_list_for_each(child, &container->children, link) {
+    struct tinywl_container *child_copy = save_subtree(child);
+    child_copy->parent = copy;
+    wl_list_insert(copy->children.prev, &child_copy->link);
+    if (container->active == child) {
+      copy->active = child_copy;
+    }
+  }
+  return copy;
+}
+
+struct tinywl_container *layout_save(struct tinywl_container *root) {
+  return save_subtree(root);
+}
+
+static bool prune(struct tinywl_container *container) {
+  if (container->toplevel != NULL || container->placeholder != NULL) {
+    return true;
+  }
+
+  struct tinywl_container *child, *tmp;
+  wl_list_for_each_safe(child, tmp, &container->children, link) {
+    if (!prune(child)) {
+      wl_list_remove(&child->link);
+      if (container->active == child) {
+        container->active = NULL;
+      }
+      free(child);
+    } else if (child->toplevel == NULL && child->placeholder == NULL &&
+               wl_list_length(&child->children) == 1) {
+      /* Collapse the split, its only child takes its place */
+      struct tinywl_container *only =
+          wl_container_of(child->children.next, only, link);
+      only->parent = container;
+      only->weight = child->weight;
+      wl_list_remove(&only->link);
+      wl_list_insert(&child->link, &only->link);
+      wl_list_remove(&child->link);
+      if (container->active == child) {
+        container->active = only;
+      }
+      free(child);
+    }
+  }
+  if (container->active == NULL && !wl_list_empty(&container->children)) {
+    container->active =
+        wl_container_of(container->children.next, container->active, link);
+  }
+  /* Empty splits and leaves whose window is gone are dropped */
+  return !wl_list_empty(&container->children);
+}
+
+static void claim_leaves(struct tinywl_container *container) {
+  struct tinywl_toplevel *toplevel = container->toplevel;
+  if (toplevel != NULL) {
+    assert(toplevel->container == NULL);
+    toplevel->container = container;
+    toplevel->home_leaf = NULL;
+    return;
+  }
+  struct tinywl_container *child;
+  wl_list_for_each(child, &container->children, link) {
+    claim_leaves(child);
+  }
+}
+
+void layout_restore(struct tinywl_container *root,
+                    struct tinywl_container *saved) {
+  assert(wl_list_empty(&root->children));
+  if (prune(saved)) {
+    root->layout = saved->layout;
+    root->active = saved->active;
+    struct tinywl_container *child, *tmp;
+    wl_list_for_each_safe(child, tmp, &saved->children, link) {
+      wl_list_remove(&child->link);
+      wl_list_insert(root->children.prev, &child->link);
+      child->parent = root;
+    }
+    claim_leaves(root);
+  }
+  free(saved);
+
+  arrange(root, &root->box, true);
+  refresh_visibility(root);
+  transaction_commit(root->workspace->output->server);
+}
+
+void layout_forget_leaf(struct tinywl_toplevel *toplevel) {
+  if (toplevel->home_leaf != NULL) {
+    toplevel->home_leaf->toplevel = NULL;
+    toplevel->home_leaf = NULL;
+  }
+}
+
+void layout_saved_destroy(struct tinywl_container *saved) {
+  if (saved == NULL) {
+    return;
+  }
+  if (saved->toplevel != NULL) {
+    saved->toplevel->home_leaf = NULL;
+  }
+  struct tinywl_container *child, *tmp;
+  wl_list_for_each_safe(child, tmp, &saved->children, link) {
+    layout_saved_destroy(child);
+  }
+  free(saved->placeholder);
+  free(saved);
+}
+
+struct tinywl_container *layout_saved_add(struct tinywl_container *parent,
+                                          enum tinywl_container_layout layout,
+                                          double weight,
+                                          const char *placeholder) {
+  struct tinywl_container *container = container_create();
+  container->layout = layout;
+  container->weight = weight;
+  if (placeholder != NULL) {
+    container->placeholder = strdup(placeholder);
+  }
+  if (parent != NULL) {
+    container->parent = parent;
+    wl_list_insert(parent->children.prev, &container->link);
+  }
+  return container;
+}
+
+void layout_fill_placeholder(struct tinywl_container *placeholder,
+                             struct tinywl_toplevel *toplevel) {
+  free(placeholder->placeholder);
+  placeholder->placeholder = NULL;
+  placeholder->toplevel = toplevel;
+  toplevel->container = placeholder;
+
+  arrange(placeholder, &placeholder->box, true);
+  refresh_visibility(placeholder);
+  transaction_commit(toplevel->server);
+}
+
+void layout_remove_placeholder(struct tinywl_container *placeholder) {
+  struct tinywl_server *server =
+      container_workspace(placeholder)->output->server;
+  struct tinywl_container *parent = detach(placeholder);
+
+  arrange(parent, &parent->box, true);
+  refresh_visibility(parent);
+  transaction_commit(server);
+}
+
+void layout_show_toplevel(struct tinywl_toplevel *toplevel) {
+  struct tinywl_container *container = toplevel->container;
+  if (container == NULL || !toplevel->tab_hidden) {
+    return;
+  }
+
+  /* Every tabbed ancestor switches to the tab holding the window. The
+   * windows all have their size already, only scene nodes are swapped. */
+  struct tinywl_container *top = container;
+  for (; container->parent != NULL; container = container->parent) {
+    if (is_tabbed(container->parent) &&
+        container->parent->active != container) {
+      container->parent->active = container;
+      update_tab_bar(container->parent);
+      top = container->parent;
+    }
+  }
+  refresh_visibility(top);
+}
+
+static struct tinywl_toplevel *
+recent_toplevel_in(struct tinywl_container *container) {
+  /* server->toplevels is in focus order */
+  struct tinywl_server *server =
+      container_workspace(container)->output->server;
+  struct tinywl_toplevel *toplevel;
+  wl_list_for_each(toplevel, &server->toplevels, link) {
+    for (struct tinywl_container *c = toplevel->container; c != NULL;
+         c = c->parent) {
+      if (c == container) {
+        return toplevel;
+      }
+    }
+  }
+  return NULL;
+}
+
+static struct tinywl_toplevel *tab_at(struct tinywl_container *container,
+                                      double lx, double ly) {
+  if (container->toplevel != NULL ||
+      !wlr_box_contains_point(&container->box, lx, ly)) {
+    return NULL;
+  }
+
+  int count = wl_list_length(&container->children), index = 0;
+  struct tinywl_container *child;
+  wl_list_for_each(child, &container->children, link) {
+    if (is_tabbed(container)) {
+      struct wlr_box box;
+      tab_box(container, index++, count, &box);
+      if (wlr_box_contains_point(&box, lx, ly)) {
+        return recent_toplevel_in(child);
+      }
+      if (child != container->active) {
+        continue;
+      }
+    }
+    struct tinywl_toplevel *found = tab_at(child, lx, ly);
+    if (found != NULL) {
+      return found;
+    }
+  }
+  return NULL;
+}
+
+struct tinywl_toplevel *layout_tab_at(struct tinywl_server *server, double lx,
+                                      double ly) {
+  struct tinywl_output *output = output_at(server, lx, ly);
+  if (output == NULL) {
+    return NULL;
+  }
+  return tab_at(output->active_workspace->root, lx, ly);
+}
+
+static void set_focused_layout(struct tinywl_server *server,
+                               enum tinywl_container_layout layout) {
+  struct tinywl_toplevel *toplevel = get_focused_toplevel(server);
+  if (toplevel == NULL || toplevel->container == NULL) {
+    return;
+  }
+  struct tinywl_container *container = toplevel->container->parent;
+  if (layout == TINYWL_LAYOUT_SPLIT_H || layout == TINYWL_LAYOUT_SPLIT_V) {
+    layout = container->box.width >= container->box.height
+                 ? TINYWL_LAYOUT_SPLIT_H
+                 : TINYWL_LAYOUT_SPLIT_V;
+  }
+  if (container->layout == layout) {
+    return;
+  }
+  container->layout = layout;
+  container->active = toplevel->container;
+
+  arrange(container, &container->box, true);
+  refresh_visibility(container);
+  transaction_commit(server);
+}
+
+void tab_focused_container(struct tinywl_server *server) {
+  set_focused_layout(server, TINYWL_LAYOUT_TABBED);
+}
+
+void stack_focused_container(struct tinywl_server *server) {
+  set_focused_layout(server, TINYWL_LAYOUT_STACKED);
+}
+
+void split_focused_container(struct tinywl_server *server) {
+  set_focused_layout(server, TINYWL_LAYOUT_SPLIT_H);
+}
+
+void grow_focused_toplevel(struct tinywl_server *server) {
+  struct tinywl_toplevel *toplevel = get_focused_toplevel(server);
+  if (toplevel != NULL) {
+    layout_resize(toplevel, 0.1);
+  }
+}
+
+void shrink_focused_toplevel(struct tinywl_server *server) {
+  struct tinywl_toplevel *toplevel = get_focused_toplevel(server);
+  if (toplevel != NULL) {
+    layout_resize(toplevel, -0.1);
+  }
+}
@@ -0,0 +1,281 @@
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "config.h"
+#include "log.h"
+
+/* Number of slots in the ring, must be a power of two */
+#define LOG_RING_SIZE 1024
+/* Longer messages are truncated */
+#define LOG_MSG_SIZE 512
+/* The writer batches formatted lines up to this size per write() */
+#define LOG_WRITE_BATCH 8192
+
+#define NSEC_PER_SEC 1000000000LL
+
+/*
+ * A single queued message. seq == position means the slot is free for the
+ * producer claiming that position, seq == position + 1 means it holds a
+ * message that the writer can consume.
+ */
+struct log_slot {
+  atomic_size_t seq;
+  enum wlr_log_importance importance;
+  struct timespec when;
+  char msg[LOG_MSG_SIZE];
+};
+
+static struct {
+  struct log_slot slots[LOG_RING_SIZE];
+  atomic_size_t enqueue_pos;
+  size_t dequeue_pos; /* Only touched by the writer thread */
+  atomic_ulong dropped;
+  atomic_bool running;
+  sem_t pending;
+  pthread_t thread;
+  struct timespec start;
+  enum wlr_log_importance level;
+  bool active;
+
+  /* Token bucket used for rate limiting */
+  atomic_long tokens;
+  atomic_llong last_refill;
+} sink;
+
+static const char *level_names[] = {
+    [WLR_SILENT] = "silent",
+    [WLR_ERROR] = "error",
+    [WLR_INFO] = "info",
+    [WLR_DEBUG] = "debug",
+};
+
+static const char *level_tags[] = {
+    [WLR_SILENT] = "",
+    [WLR_ERROR] = "[ERROR]",
+    [WLR_INFO] = "[INFO]",
+    [WLR_DEBUG] = "[DEBUG]",
+};
+
+static int64_t timespec_to_ns(const struct timespec *ts) {
+  return (int64_t)ts->tv_sec * NSEC_PER_SEC + ts->tv_nsec;
+}
+
+static bool take_token(void) {
+  struct timespec now_ts;
+  clock_gettime(CLOCK_MONOTONIC, &now_ts);
+  int64_t now = timespec_to_ns(&now_ts);
+
+  /* Refill the bucket with the tokens earned since the last refill. Only the
+   * producer that wins the exchange adds them, so they are never counted
+   * twice. */
+  long long last = atomic_load_explicit(&sink.last_refill, memory_order_relaxed);
+  long long refill = (now - last) * LOG_RATE_LIMIT / NSEC_PER_SEC;
+  if (refill > 0) {
+    long long next = refill >= LOG_RATE_BURST
+                         ? now
+                         : last + refill * NSEC_PER_SEC / LOG_RATE_LIMIT;
+    if (atomic_compare_exchange_strong(&sink.last_refill, &last, next)) {
+      long tokens = atomic_load(&sink.tokens);
+      long updated;
+      do {
+        updated = tokens + refill;
+        if (updated > LOG_RATE_BURST) {
+          updated = LOG_RATE_BURST;
+        }
+      } while (!atomic_compare_exchange_weak(&sink.tokens, &tokens, updated));
+    }
+  }
+
+  long tokens = atomic_load(&sink.tokens);
+  while (tokens > 0) {
+    if (atomic_compare_exchange_weak(&sink.tokens, &tokens, tokens - 1)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void log_callback(enum wlr_log_importance importance, const char *fmt,
+                         va_list args) {
+  /* Runs on whichever thread called wlr_log(), normally the compositor
+   * thread. Nothing in here may block. */
+  if (importance != WLR_ERROR && !take_token()) {
+    atomic_fetch_add_explicit(&sink.dropped, 1, memory_order_relaxed);
+    return;
+  }
+
+  size_t pos = atomic_load_explicit(&sink.enqueue_pos, memory_order_relaxed);
+  struct log_slot *slot;
+  for (;;) {
+    slot = &sink.slots[pos & (LOG_RING_SIZE - 1)];
+    size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+    intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+    if (diff == 0) {
+      if (atomic_compare_exchange_weak_explicit(&sink.enqueue_pos, &pos,
+                                                pos + 1, memory_order_relaxed,
+                                                memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      /* The ring is full because the writer is stuck behind a slow stderr.
+       * Drop the message rather than wait for it. */
+      atomic_fetch_add_explicit(&sink.dropped, 1, memory_order_relaxed);
+      return;
+    } else {
+      pos = atomic_load_explicit(&sink.enqueue_pos, memory_order_relaxed);
+    }
+  }
+
+  slot->importance = importance;
+  clock_gettime(CLOCK_MONOTONIC, &slot->when);
+  vsnprintf(slot->msg, sizeof(slot->msg), fmt, args);
+  atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+
+  sem_post(&sink.pending);
+}
+
+static void write_all(const char *buf, size_t len) {
+  while (len > 0) {
+    ssize_t written = write(STDERR_FILENO, buf, len);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return;
+    }
+    buf += written;
+    len -= written;
+  }
+}
+
+static size_t format_line(char *buf, size_t size, const struct log_slot *slot) {
+  int64_t elapsed =
+      timespec_to_ns(&slot->when) - timespec_to_ns(&sink.start);
+  int64_t ms = elapsed / 1000000;
+  int len = snprintf(buf, size, "%02d:%02d:%02d.%03d %s %s\n",
+                     (int)(ms / 3600000), (int)(ms / 60000 % 60),
+                     (int)(ms / 1000 % 60), (int)(ms % 1000),
+                     level_tags[slot->importance], slot->msg);
+  if (len < 0) {
+    return 0;
+  }
+  return (size_t)len < size ? (size_t)len : size - 1;
+}
+
+static void *log_writer(void *data) {
+  (void)data; // data is unused here
+  char batch[LOG_WRITE_BATCH];
+  char line[LOG_MSG_SIZE + 64];
+
+  for (;;) {
+    while (sem_wait(&sink.pending) != 0 && errno == EINTR) {
+    }
+    /* Read this before draining, everything queued before log_finish()
+     * flipped it is then guaranteed to be written. */
+    bool running = atomic_load(&sink.running);
+
+    size_t batch_len = 0;
+    for (;;) {
+      struct log_slot *slot =
+          &sink.slots[sink.dequeue_pos & (LOG_RING_SIZE - 1)];
+      size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+      if (seq != sink.dequeue_pos + 1) {
+        break;
+      }
+
+      size_t line_len = format_line(line, sizeof(line), slot);
+      atomic_store_explicit(&slot->seq, sink.dequeue_pos + LOG_RING_SIZE,
+                            memory_order_release);
+      sink.dequeue_pos++;
+
+      if (batch_len + line_len > sizeof(batch)) {
+        write_all(batch, batch_len);
+        batch_len = 0;
+      }
+      memcpy(batch + batch_len, line, line_len);
+      batch_len += line_len;
+    }
+
+    unsigned long dropped = atomic_exchange(&sink.dropped, 0);
+    if (dropped > 0) {
+      int len = snprintf(line, sizeof(line),
+                         "[nocturne] %lu log messages dropped\n", dropped);
+      if (batch_len + len > sizeof(batch)) {
+        write_all(batch, batch_len);
+        batch_len = 0;
+      }
+      memcpy(batch + batch_len, line, len);
+      batch_len += len;
+    }
+
+    write_all(batch, batch_len);
+
+    if (!running) {
+      break;
+    }
+  }
+  return NULL;
+}
+
+bool log_level_from_name(const char *name, enum wlr_log_importance *level) {
+  for (int i = 0; i < WLR_LOG_IMPORTANCE_LAST; i++) {
+    if (strcmp(name, level_names[i]) == 0) {
+      *level = i;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool log_init(enum wlr_log_importance level) {
+  sink.level = level;
+  clock_gettime(CLOCK_MONOTONIC, &sink.start);
+
+  for (size_t i = 0; i < LOG_RING_SIZE; i++) {
+    atomic_init(&sink.slots[i].seq, i);
+  }
+  atomic_init(&sink.enqueue_pos, 0);
+  sink.dequeue_pos = 0;
+  atomic_init(&sink.dropped, 0);
+  atomic_init(&sink.tokens, LOG_RATE_BURST);
+  atomic_init(&sink.last_refill, timespec_to_ns(&sink.start));
+  atomic_init(&sink.running, true);
+
+  if (sem_init(&sink.pending, 0, 0) != 0) {
+    wlr_log_init(level, NULL);
+    return false;
+  }
+  if (pthread_create(&sink.thread, NULL, log_writer, NULL) != 0) {
+    sem_destroy(&sink.pending);
+    wlr_log_init(level, NULL);
+    wlr_log(WLR_ERROR, "failed to start log writer, logging synchronously");
+    return false;
+  }
+
+  sink.active = true;
+  wlr_log_init(level, log_callback);
+  return true;
+}
+
+void log_finish(void) {
+  if (!sink.active) {
+    return;
+  }
+
+  /* Switch back to the synchronous handler first so nothing new is queued
+   * while the writer drains the ring. */
+  wlr_log_init(sink.level, NULL);
+
+  atomic_store(&sink.running, false);
+  sem_post(&sink.pending);
+  pthread_join(sink.thread, NULL);
+  sem_destroy(&sink.pending);
+  sink.active = false;
+}
@@ -60,11 +60,16 @@
 #include <xkbcommon/xkbcommon.h>
 
 #include "cursor.h"
+#include "decoration.h"
 #include "input.h"
+#include "log.h"
 #include "output.h"
 #include "popup.h"
+#include "rules.h"
 #include "server.h"
+#include "session.h"
 #include "toplevel.h"
+#include "transaction.h"
 
 /*
  * Must be included for xwayland support.
@@ -79,25 +84,36 @@
  * @argc: Argument count
  * @argv: Argument array
  * @startup_cmd: Output parameter for startup command string
+ * @log_level: Output parameter for the log verbosity
  *
  * Processes CLI arguments using getopt(), the POSIX standard for doing so
  *
  * OPTIONS:
  * -h: Display program usage
  * -s <command>: Command to run after compositor starts
+ * -l <level>: Log verbosity (silent, error, info, debug)
  *
  * Return: 1 to continue initialization, 0 to exit successfully, -1 on error
  */
-int process_args(int argc, char *argv[], char **startup_cmd) {
+int process_args(int argc, char *argv[], char **startup_cmd,
+                 enum wlr_log_importance *log_level) {
   int c;
-  while ((c = getopt(argc, argv, "s:h")) != -1) {
+  while ((c = getopt(argc, argv, "s:l:h")) != -1) {
     switch (c) {
     case 'h':
-      printf("Usage: %s [-s startup command]\n", argv[0]);
+      printf("Usage: %s [-s startup command] [-l log level]\n", argv[0]);
       return 0;
     case 's':
       *startup_cmd = optarg;
       break;
+    case 'l':
+      if (!log_level_from_name(optarg, log_level)) {
+        fprintf(stderr,
+                "Unknown log level '%s'. Use silent, error, info or debug.\n",
+                optarg);
+        return -1;
+      }
+      break;
       /*
        * getopt returns '?' if it encounters an unknown option (e.g, if we tried
        *  using -q without including it in shortopts). optopt is the actual
@@ -110,7 +126,7 @@ int process_args(int argc, char *argv[], char **startup_cmd) {
     }
     /* Check for extra options that aren't associated with any flag */
     if (optind < argc) {
-      printf("Usage: %s [-s startup command]\n", argv[0]);
+      printf("Usage: %s [-s startup command] [-l log level]\n", argv[0]);
       return -1;
     }
   }
@@ -163,12 +179,33 @@ static bool setup_shell_and_input(struct tinywl_server *server) {
    * wl_list is a circular doubly-linked list provided by Wayland.
    */
   wl_list_init(&server->toplevels);
+  wl_list_init(&server->thumbnails);
+  wl_list_init(&server->animations);
+
+  /*
+   * Layout changes are applied atomically once every affected client has
+   * caught up, see transaction.h.
+   */
+  transaction_init(server);
+
+  /*
+   * Window rules are compiled once, matching them when a window is mapped
+   * only looks at the rules for its app_id, see rules.h.
+   */
+  rules_init(server);
+
+  /*
+   * The arrangement of the last session is read before the backend starts,
+   * so the first outputs and windows find their places, see session.h.
+   */
+  session_init(server);
 
   /*
    * Set up xdg-shell. The xdg-shell is a Wayland protocol which is
-   * used for application windows.
+   * used for application windows. Version 6 adds the suspended state, which
+   * tells clients that their window can't be seen, see occlusion.h.
    */
-  server->xdg_shell = wlr_xdg_shell_create(server->wl_display, 3);
+  server->xdg_shell = wlr_xdg_shell_create(server->wl_display, 6);
 
   /*
    * Register event listeners for new XDG shell surfaces.
@@ -180,6 +217,16 @@ static bool setup_shell_and_input(struct tinywl_server *server) {
   server->new_xdg_popup.notify = server_new_xdg_popup;
   wl_signal_add(&server->xdg_shell->events.new_popup, &server->new_xdg_popup);
 
+  /*
+   * Ask windows to leave their decorations to us, so they don't draw
+   * titlebars and shadows inside their buffers, see decoration.h.
+   */
+  server->xdg_decoration_manager =
+      wlr_xdg_decoration_manager_v1_create(server->wl_display);
+  server->new_toplevel_decoration.notify = server_new_toplevel_decoration;
+  wl_signal_add(&server->xdg_decoration_manager->events.new_toplevel_decoration,
+                &server->new_toplevel_decoration);
+
   /*
    * Creates a cursor, which is a wlroots utility for tracking the cursor
    * image shown on screen. The cursor:
@@ -249,6 +296,19 @@ static bool setup_shell_and_input(struct tinywl_server *server) {
   server->cursor_frame.notify = server_cursor_frame;
   wl_signal_add(&server->cursor->events.frame, &server->cursor_frame);
 
+  /*
+   * Focus follows the pointer once it rests on a window, the timer marks
+   * the end of the rest, see cursor.h.
+   */
+  server->focus_timer =
+      wl_event_loop_add_timer(wl_display_get_event_loop(server->wl_display),
+                              cursor_focus_timeout, server);
+
+  /* Resize snapshots are only shown for so long, see cursor.h */
+  server->resize_timer =
+      wl_event_loop_add_timer(wl_display_get_event_loop(server->wl_display),
+                              cursor_resize_timeout, server);
+
   /*
    * Configures a seat, which is a single "seat" at which a user sits and
    * operates the computer. This conceptually includes up to one keyboard,
@@ -539,6 +599,14 @@ static bool setup_rendering(struct tinywl_server *server) {
    */
   server->output_layout = wlr_output_layout_create(server->wl_display);
 
+  /*
+   * Tiling trees follow their output's box, so we need to know whenever an
+   * output is moved or changes size.
+   */
+  server->output_layout_change.notify = server_output_layout_change;
+  wl_signal_add(&server->output_layout->events.change,
+                &server->output_layout_change);
+
   /*
    * Configure a listener to be notified when new outputs are available on the
    * backend. This event fires when:
@@ -547,6 +615,7 @@ static bool setup_rendering(struct tinywl_server *server) {
    * - The compositor starts up (fired once per monitor)
    */
   wl_list_init(&server->outputs);
+  wl_list_init(&server->saved_outputs);
   server->new_output.notify = server_new_output;
   wl_signal_add(&server->backend->events.new_output, &server->new_output);
 
@@ -597,8 +666,8 @@ static bool setup_rendering(struct tinywl_server *server) {
  * Handles CLI argument parsing, initialization of compositor, and cleanup.
  *
  * Orchestrates the initialization sequence:
- * - Initialize logging
  * - Parse command-line arguments
+ * - Initialize logging
  * - Set up display and backend
  * - Set up rendering pipeline
  * - Set up input handling and XDG Shell
@@ -619,22 +688,14 @@ static bool setup_rendering(struct tinywl_server *server) {
  * Return: EXIT_SUCCESS on success, EXIT_FAILURE on failure
  */
 int main(int argc, char *argv[]) {
-  /*
-   * Initialize wlroots logging.
-   * WLR_DEBUG enables verbose logging, which is useful for development.
-   * Other levels include: WLR_SILENT, WLR_ERROR, WLR_INFO
-   *
-   * NULL means log to stderr.
-   */
-  wlr_log_init(WLR_DEBUG, NULL);
-
   char *startup_cmd = NULL;
+  enum wlr_log_importance log_level = WLR_INFO;
 
   /*
    * Parse command-line arguments.
-   * This can set startup_cmd or return early on -h or error.
+   * This can set startup_cmd and log_level or return early on -h or error.
    */
-  int args_result = process_args(argc, argv, &startup_cmd);
+  int args_result = process_args(argc, argv, &startup_cmd, &log_level);
 
   if (args_result == -1) {
     exit(EXIT_FAILURE);
@@ -642,6 +703,14 @@ int main(int argc, char *argv[]) {
     exit(EXIT_SUCCESS);
   }
 
+  /*
+   * Initialize logging.
+   * Messages above log_level are discarded by wlroots before formatting. The
+   * rest are queued and written to stderr by a background thread, so a slow
+   * terminal or journald never stalls the event loop.
+   */
+  log_init(log_level);
+
   /*
    * Initialize server structure with all zeros.
    * This ensures that all pointers are NULL and all integers are 0.
@@ -656,6 +725,7 @@ int main(int argc, char *argv[]) {
       !setup_shell_and_input(&server) ||
       !finalize_startup(&server, startup_cmd)) {
     server_cleanup(&server);
+    log_finish();
     exit(EXIT_FAILURE);
   }
 
@@ -674,11 +744,17 @@ int main(int argc, char *argv[]) {
    */
   wl_display_run(server.wl_display);
 
+  /* Remember the arrangement while the windows are still there */
+  session_save(&server);
+
   /*
    * Cleanup all resources before exit.
    * This frees memory, closes file descriptors, etc.
    */
   server_cleanup(&server);
 
+  /* Flush any messages still queued for the log writer */
+  log_finish();
+
   exit(EXIT_SUCCESS);
 }
@@ -0,0 +1,105 @@
+#include <pixman.h>
+
+#include "occlusion.h"
+#include "output.h"
+#include "toplevel.h"
+#include "workspace.h"
+
+static void toplevel_set_suspended(struct tinywl_toplevel *toplevel,
+                                   bool suspended) {
+  if (toplevel->suspended == suspended ||
+      wl_resource_get_version(toplevel->xdg_toplevel->resource) <
+          XDG_TOPLEVEL_STATE_SUSPENDED_SINCE_VERSION) {
+    return;
+  }
+  toplevel->suspended = suspended;
+  wlr_xdg_toplevel_set_suspended(toplevel->xdg_toplevel, suspended);
+}
+
+static void occlude_layer(struct wlr_scene_tree *layer,
+                          const pixman_region32_t *screen,
+                          pixman_region32_t *covered) {
+  /* Children are stacked bottom to top, walk them from the top */
+  struct wlr_scene_node *node;
+  wl_list_for_each_reverse(node, &layer->children, link) {
+    struct tinywl_toplevel *toplevel = node->data;
+    if (toplevel == NULL) {
+      /* Not a window, e.g. a closing window fading out */
+      continue;
+    }
+    struct wlr_box *geo_box = &toplevel->xdg_toplevel->base->geometry;
+
+    pixman_region32_t visible;
+    pixman_region32_init_rect(&visible, node->x, node->y, geo_box->width,
+                              geo_box->height);
+    pixman_region32_intersect(&visible, &visible, screen);
+    pixman_region32_subtract(&visible, &visible, covered);
+    bool shown = node->enabled && pixman_region32_not_empty(&visible);
+    pixman_region32_fini(&visible);
+    toplevel_set_suspended(toplevel, !shown && !toplevel->in_transaction);
+
+    if (!node->enabled) {
+      continue;
+    }
+    /* The surface sits at the geometry offset from the node, see toplevel.h */
+    struct wlr_surface *surface = toplevel->xdg_toplevel->base->surface;
+    pixman_region32_t opaque;
+    pixman_region32_init(&opaque);
+    pixman_region32_copy(&opaque, &surface->opaque_region);
+    pixman_region32_translate(&opaque, node->x - geo_box->x,
+                              node->y - geo_box->y);
+    pixman_region32_union(covered, covered, &opaque);
+    pixman_region32_fini(&opaque);
+  }
+}
+
+static void occlusion_update(void *data) {
+  struct tinywl_server *server = data;
+  server->occlusion_idle = NULL;
+
+  pixman_region32_t screen, covered;
+  pixman_region32_init(&screen);
+  pixman_region32_init(&covered);
+
+  struct tinywl_output *output;
+  wl_list_for_each(output, &server->outputs, link) {
+    struct wlr_box box;
+    wlr_output_layout_get_box(server->output_layout, output->wlr_output, &box);
+    pixman_region32_union_rect(&screen, &screen, box.x, box.y, box.width,
+                               box.height);
+  }
+
+  wl_list_for_each(output, &server->outputs, link) {
+    struct tinywl_workspace *workspace = output->active_workspace;
+    occlude_layer(workspace->floating_tree, &screen, &covered);
+    occlude_layer(workspace->tiled_tree, &screen, &covered);
+  }
+
+  /* Windows on hidden workspaces weren't walked above */
+  struct tinywl_toplevel *toplevel;
+  wl_list_for_each(toplevel, &server->toplevels, link) {
+    struct tinywl_workspace *workspace = toplevel->workspace;
+    if (workspace == NULL || workspace->output->active_workspace != workspace) {
+      toplevel_set_suspended(toplevel, !toplevel->in_transaction);
+    }
+  }
+
+  pixman_region32_fini(&covered);
+  pixman_region32_fini(&screen);
+}
+
+void occlusion_schedule(struct tinywl_server *server) {
+  if (server->occlusion_idle != NULL) {
+    return;
+  }
+  server->occlusion_idle =
+      wl_event_loop_add_idle(wl_display_get_event_loop(server->wl_display),
+                             occlusion_update, server);
+}
+
+void occlusion_finish(struct tinywl_server *server) {
+  if (server->occlusion_idle != NULL) {
+    wl_event_source_remove(server->occlusion_idle);
+    server->occlusion_idle = NULL;
+  }
+}
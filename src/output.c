@@ -1,6 +1,98 @@
 #include <stdlib.h>
+#include <string.h>
 
+#include "animation.h"
+#include "cursor.h"
+#include "layout.h"
+#include "occlusion.h"
+#include "overview.h"
+#include "session.h"
+#include "spatial.h"
 #include "output.h"
+#include "toplevel.h"
+#include "transaction.h"
+#include "utils.h"
+
+static void output_update_usable_area(struct tinywl_output *output) {
+  struct tinywl_server *server = output->server;
+  struct wlr_box box;
+  wlr_output_layout_get_box(server->output_layout, output->wlr_output, &box);
+  if (wlr_box_empty(&box) || wlr_box_equal(&box, &output->usable_area)) {
+    return;
+  }
+  output->usable_area = box;
+
+  for (int i = 0; i < WORKSPACE_COUNT; i++) {
+    spatial_workspace_set_area(&output->workspaces[i], &box);
+    layout_set_root_box(output->workspaces[i].root, &output->usable_area);
+  }
+  struct tinywl_toplevel *toplevel;
+  wl_list_for_each(toplevel, &server->toplevels, link) {
+    if (toplevel->maximized && toplevel->workspace != NULL &&
+        toplevel->workspace->output == output) {
+      toplevel_set_maximized(toplevel, true);
+    }
+  }
+  transaction_commit(server);
+}
+
+struct frame_done_data {
+  struct wlr_scene_output *scene_output;
+  struct wlr_scene_frame_done_event event;
+  struct tinywl_toplevel *focused;
+  uint64_t now_ns;
+  uint64_t interval_ns;
+  uint64_t withheld_due_ns; /* Earliest callback held back, 0 if none */
+};
+
+static struct tinywl_toplevel *buffer_toplevel(struct wlr_scene_buffer *buffer) {
+  /* The toplevel's scene tree is the only ancestor with its data set */
+  struct wlr_scene_tree *tree = buffer->node.parent;
+  while (tree != NULL && tree->node.data == NULL) {
+    tree = tree->node.parent;
+  }
+  return tree != NULL ? tree->node.data : NULL;
+}
+
+static void send_frame_done_iterator(struct wlr_scene_buffer *buffer, int sx,
+                                     int sy, void *user_data) {
+  (void)sx; // buffer coordinates are unused here
+  (void)sy;
+  struct frame_done_data *frame = user_data;
+
+  /* Buffers visible on several outputs only follow their primary one */
+  if (buffer->primary_output != frame->scene_output) {
+    return;
+  }
+
+  struct tinywl_toplevel *toplevel = buffer_toplevel(buffer);
+  if (toplevel != NULL && toplevel != frame->focused &&
+      !toplevel->unthrottled &&
+      toplevel != toplevel->server->grabbed_toplevel &&
+      !toplevel->in_transaction && frame->interval_ns > 0) {
+    /* Every surface of the window is handled within the same frame, they
+     * all see the same timestamp */
+    if (toplevel->last_frame_ns != frame->now_ns &&
+        frame->now_ns - toplevel->last_frame_ns < frame->interval_ns) {
+      uint64_t due_ns = toplevel->last_frame_ns + frame->interval_ns;
+      if (frame->withheld_due_ns == 0 || due_ns < frame->withheld_due_ns) {
+        frame->withheld_due_ns = due_ns;
+      }
+      return;
+    }
+    toplevel->last_frame_ns = frame->now_ns;
+  }
+
+  wlr_scene_buffer_send_frame_done(buffer, &frame->event);
+}
+
+static int output_throttle_timeout(void *data) {
+  /* A callback was held back, the frame that sends it may not come on its
+   * own if nothing else damages the output */
+  struct tinywl_output *output = data;
+  wlr_output_schedule_frame(output->wlr_output);
+  return 0;
+}
 
 static void output_frame(struct wl_listener *listener, void *data) {
   (void)data; // data is unused here
@@ -12,12 +104,43 @@ static void output_frame(struct wl_listener *listener, void *data) {
   struct wlr_scene_output *scene_output =
       wlr_scene_get_scene_output(scene, output->wlr_output);
 
+  /* Interactive moves are applied once per frame, see cursor.h */
+  cursor_apply_move(output->server);
+  cursor_focus_frame(output->server);
+  overview_frame(output);
+  bool animating = animation_frame(output);
+
   /* Render the scene if needed and commit the output */
+  uint64_t render_start = animating ? monotonic_ns() : 0;
   wlr_scene_output_commit(scene_output, NULL);
+  if (animating) {
+    animation_report_frame(output->server, monotonic_ns() - render_start);
+  }
 
-  struct timespec now;
-  clock_gettime(CLOCK_MONOTONIC, &now);
-  wlr_scene_output_send_frame_done(scene_output, &now);
+  struct frame_done_data frame = {
+      .scene_output = scene_output,
+      .event = {.output = scene_output},
+      .focused = get_focused_toplevel(output->server),
+  };
+  clock_gettime(CLOCK_MONOTONIC, &frame.event.when);
+  frame.now_ns = (uint64_t)frame.event.when.tv_sec * 1000000000 +
+                 frame.event.when.tv_nsec;
+#if UNFOCUSED_FRAME_RATE > 0
+  frame.interval_ns = 1000000000 / UNFOCUSED_FRAME_RATE;
+  /* Half a frame of slack, refresh is in mHz and 0 if unknown */
+  int refresh = output->wlr_output->refresh;
+  if (refresh > 0 && 500000000000ULL / refresh < frame.interval_ns) {
+    frame.interval_ns -= 500000000000ULL / refresh;
+  }
+#endif
+  wlr_scene_output_for_each_buffer(scene_output, send_frame_done_iterator,
+                                   &frame);
+  if (frame.withheld_due_ns != 0) {
+    uint64_t wait_ns = frame.withheld_due_ns - frame.now_ns;
+    wl_event_source_timer_update(output->throttle_timer,
+                                 (int)((wait_ns + 999999) / 1000000));
+  }
+  cursor_resize_frame(output, &frame.event.when);
 }
 
 static void output_request_state(struct wl_listener *listener, void *data) {
@@ -30,6 +153,140 @@ static void output_request_state(struct wl_listener *listener, void *data) {
   wlr_output_commit_state(output->wlr_output, event->state);
 }
 
+static void saved_output_destroy(struct tinywl_saved_output *saved,
+                                 struct tinywl_server *server) {
+  for (int i = 0; i < WORKSPACE_COUNT; i++) {
+    layout_saved_destroy(saved->trees[i]);
+  }
+  struct tinywl_toplevel *toplevel;
+  wl_list_for_each(toplevel, &server->toplevels, link) {
+    if (toplevel->home == saved) {
+      toplevel->home = NULL;
+    }
+  }
+  wl_list_remove(&saved->link);
+  free(saved->name);
+  free(saved);
+}
+
+static struct tinywl_saved_output *saved_output_find(struct tinywl_server *server,
+                                                     const char *name) {
+  struct tinywl_saved_output *saved;
+  wl_list_for_each(saved, &server->saved_outputs, link) {
+    if (strcmp(saved->name, name) == 0) {
+      return saved;
+    }
+  }
+  return NULL;
+}
+
+static void output_save_layout(struct tinywl_output *output) {
+  struct tinywl_server *server = output->server;
+  struct tinywl_saved_output *saved =
+      saved_output_find(server, output->wlr_output->name);
+  if (saved != NULL) {
+    saved_output_destroy(saved, server);
+  }
+
+  saved = calloc(1, sizeof(*saved));
+  saved->name = strdup(output->wlr_output->name);
+  saved->active_workspace = output->active_workspace->index;
+  for (int i = 0; i < WORKSPACE_COUNT; i++) {
+    saved->trees[i] = layout_save(output->workspaces[i].root);
+  }
+  wl_list_insert(&server->saved_outputs, &saved->link);
+
+  struct wlr_box box;
+  wlr_output_layout_get_box(server->output_layout, output->wlr_output, &box);
+  struct tinywl_toplevel *toplevel;
+  wl_list_for_each(toplevel, &server->toplevels, link) {
+    if (toplevel->workspace == NULL || toplevel->workspace->output != output ||
+        toplevel->home != NULL) {
+      continue;
+    }
+    toplevel->home = saved;
+    toplevel->home_workspace = toplevel->workspace->index;
+    toplevel->home_floating = toplevel->container == NULL;
+    if (toplevel->home_floating) {
+      struct wlr_box *geo_box = &toplevel->xdg_toplevel->base->geometry;
+      toplevel->home_box =
+          toplevel->maximized
+              ? toplevel->floating_box
+              : (struct wlr_box){
+                    .x = toplevel->scene_tree->node.x,
+                    .y = toplevel->scene_tree->node.y,
+                    .width = geo_box->width,
+                    .height = geo_box->height,
+                };
+      toplevel->home_box.x -= box.x;
+      toplevel->home_box.y -= box.y;
+    }
+  }
+}
+
+static void output_restore_layout(struct tinywl_output *output) {
+  struct tinywl_server *server = output->server;
+  struct tinywl_saved_output *saved =
+      saved_output_find(server, output->wlr_output->name);
+  if (saved == NULL) {
+    return;
+  }
+
+  transaction_begin_batch(server);
+  for (int i = 0; i < WORKSPACE_COUNT; i++) {
+    workspace_restore_layout(&output->workspaces[i], saved->trees[i]);
+    saved->trees[i] = NULL;
+  }
+
+  struct wlr_box box;
+  wlr_output_layout_get_box(server->output_layout, output->wlr_output, &box);
+  struct tinywl_toplevel *toplevel;
+  wl_list_for_each(toplevel, &server->toplevels, link) {
+    if (toplevel->home != saved) {
+      continue;
+    }
+    toplevel->home = NULL;
+    if (toplevel->hidden || (toplevel->workspace != NULL &&
+                             toplevel->workspace->output == output)) {
+      continue;
+    }
+
+    workspace_move_toplevel(toplevel,
+                            &output->workspaces[toplevel->home_workspace]);
+    if (!toplevel->home_floating || toplevel->container != NULL) {
+      continue;
+    }
+    /* Back exactly where it was, not just at the same relative spot on
+     * the output it was moved to */
+    if (toplevel->maximized) {
+      toplevel->floating_box = toplevel->home_box;
+      toplevel->floating_box.x += box.x;
+      toplevel->floating_box.y += box.y;
+    } else {
+      wlr_scene_node_set_position(&toplevel->scene_tree->node,
+                                  box.x + toplevel->home_box.x,
+                                  box.y + toplevel->home_box.y);
+      spatial_update_toplevel(toplevel);
+    }
+  }
+  transaction_end_batch(server);
+
+  workspace_show(&output->workspaces[saved->active_workspace]);
+  saved_output_destroy(saved, server);
+}
+
+void output_forget_toplevel(struct tinywl_toplevel *toplevel) {
+  layout_forget_leaf(toplevel);
+  toplevel->home = NULL;
+}
+
+void output_saved_finish(struct tinywl_server *server) {
+  struct tinywl_saved_output *saved, *tmp;
+  wl_list_for_each_safe(saved, tmp, &server->saved_outputs, link) {
+    saved_output_destroy(saved, server);
+  }
+}
+
 static void output_destroy(struct wl_listener *listener, void *data) {
   (void)data; // unused here
   struct tinywl_output *output = wl_container_of(listener, output, destroy);
@@ -38,6 +295,41 @@ static void output_destroy(struct wl_listener *listener, void *data) {
   wl_list_remove(&output->request_state.link);
   wl_list_remove(&output->destroy.link);
   wl_list_remove(&output->link);
+  wl_event_source_remove(output->throttle_timer);
+
+  /* Nothing is left to move when the compositor shuts down */
+  struct tinywl_server *server = output->server;
+  session_output_destroy(output);
+  if (!wl_list_empty(&server->toplevels)) {
+    /* Remember the layout in case the output comes back, then hand the
+     * windows over to the same workspace of a remaining output in one
+     * batch */
+    output_save_layout(output);
+    struct tinywl_output *other = NULL;
+    if (!wl_list_empty(&server->outputs)) {
+      other = wl_container_of(server->outputs.next, other, link);
+    }
+    transaction_begin_batch(server);
+    struct tinywl_toplevel *toplevel;
+    wl_list_for_each(toplevel, &server->toplevels, link) {
+      if (toplevel->workspace == NULL ||
+          toplevel->workspace->output != output) {
+        continue;
+      }
+      if (other != NULL) {
+        workspace_move_toplevel(toplevel,
+                                &other->workspaces[toplevel->workspace->index]);
+      } else {
+        workspace_remove_toplevel(toplevel);
+      }
+    }
+    transaction_end_batch(server);
+  }
+  overview_output_destroy(output);
+  for (int i = 0; i < WORKSPACE_COUNT; i++) {
+    workspace_finish(&output->workspaces[i]);
+  }
+
   free(output);
 }
 
@@ -74,10 +366,18 @@ void server_new_output(struct wl_listener *listener, void *data) {
   struct tinywl_output *output = calloc(1, sizeof(*output));
   output->wlr_output = wlr_output;
   output->server = server;
+  wlr_output->data = output;
+  for (int i = 0; i < WORKSPACE_COUNT; i++) {
+    workspace_init(&output->workspaces[i], output, i);
+  }
+  workspace_show(&output->workspaces[0]);
 
   /* Sets up a listener for the frame event. */
   output->frame.notify = output_frame;
   wl_signal_add(&wlr_output->events.frame, &output->frame);
+  output->throttle_timer =
+      wl_event_loop_add_timer(wl_display_get_event_loop(server->wl_display),
+                              output_throttle_timeout, output);
 
   /* Sets up a listener for the state request event. */
   output->request_state.notify = output_request_state;
@@ -104,4 +404,28 @@ void server_new_output(struct wl_listener *listener, void *data) {
       wlr_scene_output_create(server->scene, wlr_output);
   wlr_scene_output_layout_add_output(server->scene_layout, l_output,
                                      scene_output);
+
+  /* The output now has its place in the layout, size the tiling trees */
+  output_update_usable_area(output);
+  output_restore_layout(output);
+  session_restore_output(output);
+}
+
+void server_output_layout_change(struct wl_listener *listener, void *data) {
+  (void)data; // data is unused here
+  struct tinywl_server *server =
+      wl_container_of(listener, server, output_layout_change);
+
+  struct tinywl_output *output;
+  wl_list_for_each(output, &server->outputs, link) {
+    output_update_usable_area(output);
+  }
+  occlusion_schedule(server);
+}
+
+struct tinywl_output *output_at(struct tinywl_server *server, double lx,
+                                double ly) {
+  struct wlr_output *wlr_output =
+      wlr_output_layout_output_at(server->output_layout, lx, ly);
+  return wlr_output != NULL ? wlr_output->data : NULL;
 }
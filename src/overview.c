@@ -0,0 +1,404 @@
+#include <stdlib.h>
+#include <time.h>
+
+#include "config.h"
+#include "cursor.h"
+#include "output.h"
+#include "overview.h"
+#include "thumbnail.h"
+#include "toplevel.h"
+#include "utils.h"
+#include "workspace.h"
+
+/* Windows hidden behind the grid are sent frame callbacks at this interval */
+#if UNFOCUSED_FRAME_RATE > 0
+#define OVERVIEW_FRAME_INTERVAL_MS (1000 / UNFOCUSED_FRAME_RATE)
+#else
+#define OVERVIEW_FRAME_INTERVAL_MS 16
+#endif
+
+static struct wlr_box toplevel_box(struct tinywl_toplevel *toplevel) {
+  struct wlr_box *geo_box = &toplevel->xdg_toplevel->base->geometry;
+  return (struct wlr_box){
+      .x = toplevel->scene_tree->node.x,
+      .y = toplevel->scene_tree->node.y,
+      .width = geo_box->width,
+      .height = geo_box->height,
+  };
+}
+
+static int lerp(int from, int to, double t) {
+  return from + (int)((to - from) * t);
+}
+
+static void update_selection(struct tinywl_overview *overview) {
+  /* Only shown once the windows have settled in the grid */
+  bool shown = overview->selected >= 0 && !overview->closing &&
+               overview->progress >= 1.0;
+  wlr_scene_node_set_enabled(&overview->selection->node, shown);
+  if (!shown) {
+    return;
+  }
+  struct wlr_box *to = &overview->entries[overview->selected].to;
+  wlr_scene_node_set_position(&overview->selection->node, to->x - BORDER_WIDTH,
+                              to->y - BORDER_WIDTH);
+  wlr_scene_rect_set_size(overview->selection, to->width + 2 * BORDER_WIDTH,
+                          to->height + 2 * BORDER_WIDTH);
+}
+
+static void apply_progress(struct tinywl_overview *overview) {
+  /* Ease out, the windows slow down as they arrive */
+  double t = 1.0 - overview->progress;
+  double eased = 1.0 - t * t * t;
+
+  float background[4] = OVERVIEW_BACKGROUND_COLOR;
+  background[3] *= eased;
+  wlr_scene_rect_set_color(overview->background, background);
+
+  for (size_t i = 0; i < overview->entry_count; i++) {
+    struct tinywl_overview_entry *entry = &overview->entries[i];
+    int x = lerp(entry->from.x, entry->to.x, eased);
+    int y = lerp(entry->from.y, entry->to.y, eased);
+    int width = lerp(entry->from.width, entry->to.width, eased);
+    int height = lerp(entry->from.height, entry->to.height, eased);
+    wlr_scene_node_set_position(&entry->thumbnail->node, x, y);
+    wlr_scene_buffer_set_dest_size(entry->thumbnail, width > 0 ? width : 1,
+                                   height > 0 ? height : 1);
+  }
+  update_selection(overview);
+}
+
+static void layout_entries(struct tinywl_overview *overview) {
+  /* A square-ish grid over the usable area */
+  struct wlr_box *area = &overview->output->usable_area;
+  int count = (int)overview->entry_count;
+  int columns = 1;
+  while (columns * columns < count) {
+    columns++;
+  }
+  int rows = (count + columns - 1) / columns;
+  int cell_width = (area->width - (columns + 1) * OVERVIEW_GAP) / columns;
+  int cell_height = (area->height - (rows + 1) * OVERVIEW_GAP) / rows;
+  cell_width = cell_width > 0 ? cell_width : 1;
+  cell_height = cell_height > 0 ? cell_height : 1;
+  overview->columns = columns;
+
+  for (int i = 0; i < count; i++) {
+    struct tinywl_overview_entry *entry = &overview->entries[i];
+    struct wlr_box cell = {
+        .x = area->x + OVERVIEW_GAP + (i % columns) * (cell_width + OVERVIEW_GAP),
+        .y = area->y + OVERVIEW_GAP + (i / columns) * (cell_height + OVERVIEW_GAP),
+        .width = cell_width,
+        .height = cell_height,
+    };
+
+    /* The thumbnail fits the cell, the buffer decides the exact size */
+    struct wlr_buffer *buffer =
+        thumbnail_get(entry->toplevel, cell.width, cell.height);
+    wlr_scene_buffer_set_buffer(entry->thumbnail, buffer);
+    entry->commit_seq = entry->toplevel->commit_seq;
+    int width = buffer != NULL ? buffer->width : cell.width;
+    int height = buffer != NULL ? buffer->height : cell.height;
+    entry->to = (struct wlr_box){
+        .x = cell.x + (cell.width - width) / 2,
+        .y = cell.y + (cell.height - height) / 2,
+        .width = width,
+        .height = height,
+    };
+  }
+}
+
+static int overview_frame_timeout(void *data) {
+  struct tinywl_overview *overview = data;
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  /* Their commits schedule a frame that refreshes the thumbnails */
+  for (size_t i = 0; i < overview->entry_count; i++) {
+    if (overview->entries[i].toplevel != NULL) {
+      toplevel_send_frame_done(overview->entries[i].toplevel, &now);
+    }
+  }
+  wl_event_source_timer_update(overview->frame_timer,
+                               OVERVIEW_FRAME_INTERVAL_MS);
+  return 0;
+}
+
+static void overview_set_workspace_hidden(struct tinywl_overview *overview,
+                                          bool hidden) {
+  if (hidden == overview->workspace_hidden) {
+    return;
+  }
+  wlr_scene_node_set_enabled(&overview->workspace->tree->node, !hidden);
+  wl_event_source_timer_update(overview->frame_timer,
+                               hidden ? OVERVIEW_FRAME_INTERVAL_MS : 0);
+  overview->workspace_hidden = hidden;
+}
+
+static void overview_open(struct tinywl_server *server) {
+  struct tinywl_output *output =
+      output_at(server, server->cursor->x, server->cursor->y);
+  if (output == NULL || wlr_box_empty(&output->usable_area)) {
+    return;
+  }
+  struct tinywl_workspace *workspace = output->active_workspace;
+
+  size_t count = 0;
+  struct tinywl_toplevel *toplevel;
+  wl_list_for_each(toplevel, &server->toplevels, link) {
+    if (toplevel->workspace == workspace) {
+      count++;
+    }
+  }
+  if (count == 0) {
+    return;
+  }
+
+  /* Input goes to the overview from now on */
+  reset_cursor_mode(server);
+  wlr_seat_pointer_clear_focus(server->seat);
+  wlr_cursor_set_xcursor(server->cursor, server->cursor_mgr, "default");
+  server->cursor_default = true;
+
+  struct tinywl_overview *overview = calloc(1, sizeof(*overview));
+  overview->output = output;
+  overview->workspace = workspace;
+  overview->entries = calloc(count, sizeof(*overview->entries));
+  overview->selected = 0;
+  overview->tree = wlr_scene_tree_create(&server->scene->tree);
+  overview->frame_timer =
+      wl_event_loop_add_timer(wl_display_get_event_loop(server->wl_display),
+                              overview_frame_timeout, overview);
+
+  struct wlr_box box;
+  wlr_output_layout_get_box(server->output_layout, output->wlr_output, &box);
+  static const float transparent[4] = {0, 0, 0, 0};
+  static const float selection[4] = BORDER_COLOR_FOCUSED;
+  overview->background = wlr_scene_rect_create(overview->tree, box.width,
+                                               box.height, transparent);
+  wlr_scene_node_set_position(&overview->background->node, box.x, box.y);
+  overview->selection = wlr_scene_rect_create(overview->tree, 1, 1, selection);
+
+  struct tinywl_toplevel *focused = get_focused_toplevel(server);
+  wl_list_for_each(toplevel, &server->toplevels, link) {
+    if (toplevel->workspace != workspace) {
+      continue;
+    }
+    if (toplevel == focused) {
+      overview->selected = (int)overview->entry_count;
+    }
+    struct tinywl_overview_entry *entry =
+        &overview->entries[overview->entry_count++];
+    entry->toplevel = toplevel;
+    entry->from = toplevel_box(toplevel);
+    entry->thumbnail = wlr_scene_buffer_create(overview->tree, NULL);
+  }
+  layout_entries(overview);
+
+  server->overview = overview;
+  apply_progress(overview);
+  wlr_output_schedule_frame(output->wlr_output);
+}
+
+static void overview_destroy(struct tinywl_server *server) {
+  struct tinywl_overview *overview = server->overview;
+  overview_set_workspace_hidden(overview, false);
+  wl_event_source_remove(overview->frame_timer);
+  wlr_scene_node_destroy(&overview->tree->node);
+  free(overview->entries);
+  free(overview);
+  server->overview = NULL;
+}
+
+static void overview_close(struct tinywl_server *server,
+                           struct tinywl_toplevel *pick) {
+  struct tinywl_overview *overview = server->overview;
+  if (overview->closing) {
+    return;
+  }
+  overview->closing = true;
+
+  /* The windows have to be there to zoom back into */
+  overview_set_workspace_hidden(overview, false);
+  if (pick != NULL) {
+    focus_toplevel(pick);
+  }
+  for (size_t i = 0; i < overview->entry_count; i++) {
+    struct tinywl_overview_entry *entry = &overview->entries[i];
+    if (entry->toplevel == NULL) {
+      continue;
+    }
+    entry->from = toplevel_box(entry->toplevel);
+    if (entry->toplevel == pick) {
+      wlr_scene_node_raise_to_top(&entry->thumbnail->node);
+    }
+  }
+  update_selection(overview);
+  wlr_output_schedule_frame(overview->output->wlr_output);
+}
+
+void overview_toggle(struct tinywl_server *server) {
+  struct tinywl_overview *overview = server->overview;
+  if (overview == NULL) {
+    overview_open(server);
+  } else if (overview->closing) {
+    /* Zoom back out from wherever the windows are */
+    overview->closing = false;
+    wlr_output_schedule_frame(overview->output->wlr_output);
+  } else {
+    overview_close(server, NULL);
+  }
+}
+
+void overview_frame(struct tinywl_output *output) {
+  struct tinywl_server *server = output->server;
+  struct tinywl_overview *overview = server->overview;
+  if (overview == NULL || overview->output != output) {
+    return;
+  }
+
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  uint64_t now_ns = (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+  double step = 0.0;
+  if (overview->last_frame_ns != 0) {
+    step = (double)(now_ns - overview->last_frame_ns) /
+           (OVERVIEW_DURATION_MS * 1000000.0);
+  }
+  overview->last_frame_ns = now_ns;
+
+  /* Refresh the thumbnails of windows that committed since */
+  for (size_t i = 0; i < overview->entry_count; i++) {
+    struct tinywl_overview_entry *entry = &overview->entries[i];
+    if (entry->toplevel == NULL ||
+        entry->commit_seq == entry->toplevel->commit_seq) {
+      continue;
+    }
+    struct wlr_buffer *buffer =
+        thumbnail_get(entry->toplevel, entry->to.width, entry->to.height);
+    if (buffer != NULL) {
+      wlr_scene_buffer_set_buffer(entry->thumbnail, buffer);
+    }
+    entry->commit_seq = entry->toplevel->commit_seq;
+  }
+
+  bool animating = overview->closing ? overview->progress > 0.0
+                                     : overview->progress < 1.0;
+  if (!animating) {
+    return;
+  }
+  overview->progress += overview->closing ? -step : step;
+  if (overview->progress <= 0.0 && overview->closing) {
+    overview_destroy(server);
+    return;
+  }
+  if (overview->progress >= 1.0 && !overview->closing) {
+    overview->progress = 1.0;
+    /* Nothing of the workspace can be seen through the grid anymore */
+    overview_set_workspace_hidden(overview, true);
+  }
+  apply_progress(overview);
+  if (overview->progress < 1.0) {
+    wlr_output_schedule_frame(output->wlr_output);
+  }
+}
+
+void overview_handle_key(struct tinywl_server *server, xkb_keysym_t sym) {
+  struct tinywl_overview *overview = server->overview;
+  int count = (int)overview->entry_count;
+  int selected = overview->selected >= 0 ? overview->selected : 0;
+  switch (sym) {
+  case XKB_KEY_Escape:
+    overview_close(server, NULL);
+    return;
+  case XKB_KEY_Return:
+    if (overview->selected >= 0) {
+      overview_close(server, overview->entries[overview->selected].toplevel);
+    }
+    return;
+  case XKB_KEY_Left:
+  case XKB_KEY_h:
+    selected = (selected + count - 1) % count;
+    break;
+  case XKB_KEY_Right:
+  case XKB_KEY_l:
+    selected = (selected + 1) % count;
+    break;
+  case XKB_KEY_Up:
+  case XKB_KEY_k:
+    if (selected - overview->columns >= 0) {
+      selected -= overview->columns;
+    }
+    break;
+  case XKB_KEY_Down:
+  case XKB_KEY_j:
+    if (selected + overview->columns < count) {
+      selected += overview->columns;
+    }
+    break;
+  default:
+    return;
+  }
+  if (overview->entries[selected].toplevel != NULL) {
+    overview->selected = selected;
+    update_selection(overview);
+  }
+}
+
+static int entry_at(struct tinywl_overview *overview, double lx, double ly) {
+  for (size_t i = 0; i < overview->entry_count; i++) {
+    struct tinywl_overview_entry *entry = &overview->entries[i];
+    if (entry->toplevel != NULL &&
+        wlr_box_contains_point(&entry->to, lx, ly)) {
+      return (int)i;
+    }
+  }
+  return -1;
+}
+
+void overview_pointer_motion(struct tinywl_server *server) {
+  struct tinywl_overview *overview = server->overview;
+  int i = entry_at(overview, server->cursor->x, server->cursor->y);
+  if (i >= 0 && i != overview->selected) {
+    overview->selected = i;
+    update_selection(overview);
+  }
+}
+
+void overview_pointer_button(struct tinywl_server *server) {
+  struct tinywl_overview *overview = server->overview;
+  int i = entry_at(overview, server->cursor->x, server->cursor->y);
+  overview_close(server, i >= 0 ? overview->entries[i].toplevel : NULL);
+}
+
+void overview_toplevel_commit(struct tinywl_toplevel *toplevel) {
+  struct tinywl_overview *overview = toplevel->server->overview;
+  if (overview != NULL && toplevel->workspace == overview->workspace) {
+    wlr_output_schedule_frame(overview->output->wlr_output);
+  }
+}
+
+void overview_toplevel_unmap(struct tinywl_toplevel *toplevel) {
+  struct tinywl_overview *overview = toplevel->server->overview;
+  if (overview == NULL) {
+    return;
+  }
+  for (size_t i = 0; i < overview->entry_count; i++) {
+    struct tinywl_overview_entry *entry = &overview->entries[i];
+    if (entry->toplevel != toplevel) {
+      continue;
+    }
+    entry->toplevel = NULL;
+    wlr_scene_node_set_enabled(&entry->thumbnail->node, false);
+    if (overview->selected == (int)i) {
+      overview->selected = -1;
+      update_selection(overview);
+    }
+  }
+}
+
+void overview_output_destroy(struct tinywl_output *output) {
+  struct tinywl_overview *overview = output->server->overview;
+  if (overview != NULL && overview->output == output) {
+    overview_destroy(output->server);
+  }
+}
@@ -1,9 +1,43 @@
-#include "assert.h"
 #include <stdlib.h>
 #include <wlr/types/wlr_scene.h>
 #include <wlr/types/wlr_xdg_shell.h>
 
+#include "output.h"
 #include "popup.h"
+#include "spatial.h"
+#include "toplevel.h"
+#include "workspace.h"
+
+static struct tinywl_toplevel *popup_toplevel(struct tinywl_popup *popup) {
+  /* The window is the first ancestor with its data field set */
+  struct wlr_scene_tree *tree = popup->xdg_popup->base->data;
+  while (tree != NULL && tree->node.data == NULL) {
+    tree = tree->node.parent;
+  }
+  return tree != NULL ? tree->node.data : NULL;
+}
+
+static void popup_unconstrain(struct tinywl_popup *popup) {
+  struct tinywl_toplevel *toplevel = popup_toplevel(popup);
+  if (toplevel == NULL || toplevel->workspace == NULL) {
+    return;
+  }
+
+  /* The usable area in the coordinates of the window's root surface. Tiled
+   * windows may still be on their way to their tile. */
+  struct wlr_box *area = &toplevel->workspace->output->usable_area;
+  struct wlr_scene_node *node = &toplevel->scene_tree->node;
+  struct wlr_box *geo_box = &toplevel->xdg_toplevel->base->geometry;
+  int x = toplevel->container != NULL ? toplevel->tile.x : node->x;
+  int y = toplevel->container != NULL ? toplevel->tile.y : node->y;
+  struct wlr_box box = {
+      .x = area->x - x + geo_box->x,
+      .y = area->y - y + geo_box->y,
+      .width = area->width,
+      .height = area->height,
+  };
+  wlr_xdg_popup_unconstrain_from_box(popup->xdg_popup, &box);
+}
 
 static void xdg_popup_commit(struct wl_listener *listener, void *data) {
   (void)data; // data is unused here
@@ -12,12 +46,26 @@ static void xdg_popup_commit(struct wl_listener *listener, void *data) {
 
   if (popup->xdg_popup->base->initial_commit) {
     /* When an xdg_surface performs an initial commit, the compositor must
-     * reply with a configure so the client can map the surface.
-     * tinywl sends an empty configure. A more sophisticated compositor
-     * might change an xdg_popup's geometry to ensure it's not positioned
-     * off-screen, for example. */
+     * reply with a configure so the client can map the surface. The popup
+     * is fitted to the output before the first configure, so it maps in
+     * place without being moved back on screen afterwards. */
+    popup_unconstrain(popup);
     wlr_xdg_surface_schedule_configure(popup->xdg_popup->base);
   }
+
+  /* The popup grows its window's bounding box in the spatial index */
+  struct tinywl_toplevel *toplevel = popup_toplevel(popup);
+  if (toplevel != NULL && toplevel->workspace != NULL) {
+    spatial_update_toplevel(toplevel);
+  }
+}
+
+static void xdg_popup_reposition(struct wl_listener *listener, void *data) {
+  (void)data; // data is unused here
+  /* The client gave the popup a new positioner, fit it again. wlroots
+   * already scheduled the configure. */
+  struct tinywl_popup *popup = wl_container_of(listener, popup, reposition);
+  popup_unconstrain(popup);
 }
 
 static void xdg_popup_destroy(struct wl_listener *listener, void *data) {
@@ -26,6 +74,7 @@ static void xdg_popup_destroy(struct wl_listener *listener, void *data) {
   struct tinywl_popup *popup = wl_container_of(listener, popup, destroy);
 
   wl_list_remove(&popup->commit.link);
+  wl_list_remove(&popup->reposition.link);
   wl_list_remove(&popup->destroy.link);
 
   free(popup);
@@ -36,6 +85,18 @@ void server_new_xdg_popup(struct wl_listener *listener, void *data) {
   /* This event is raised when a client creates a new popup. */
   struct wlr_xdg_popup *xdg_popup = data;
 
+  /* Only popups of xdg surfaces have a place in the scene, dismiss the
+   * others rather than leave the client waiting for a configure */
+  struct wlr_xdg_surface *parent =
+      xdg_popup->parent != NULL
+          ? wlr_xdg_surface_try_from_wlr_surface(xdg_popup->parent)
+          : NULL;
+  if (parent == NULL || parent->data == NULL) {
+    wlr_log(WLR_DEBUG, "Dismissing popup without an xdg parent");
+    wlr_xdg_popup_destroy(xdg_popup);
+    return;
+  }
+
   struct tinywl_popup *popup = calloc(1, sizeof(*popup));
   popup->xdg_popup = xdg_popup;
 
@@ -44,9 +105,6 @@ void server_new_xdg_popup(struct wl_listener *listener, void *data) {
    * provide the proper parent scene node of the xdg popup. To enable this,
    * we always set the user data field of xdg_surfaces to the corresponding
    * scene node. */
-  struct wlr_xdg_surface *parent =
-      wlr_xdg_surface_try_from_wlr_surface(xdg_popup->parent);
-  assert(parent != NULL);
   struct wlr_scene_tree *parent_tree = parent->data;
   xdg_popup->base->data =
       wlr_scene_xdg_surface_create(parent_tree, xdg_popup->base);
@@ -54,6 +112,19 @@ void server_new_xdg_popup(struct wl_listener *listener, void *data) {
   popup->commit.notify = xdg_popup_commit;
   wl_signal_add(&xdg_popup->base->surface->events.commit, &popup->commit);
 
+  popup->reposition.notify = xdg_popup_reposition;
+  wl_signal_add(&xdg_popup->events.reposition, &popup->reposition);
+
   popup->destroy.notify = xdg_popup_destroy;
   wl_signal_add(&xdg_popup->events.destroy, &popup->destroy);
 }
+
+void popup_dismiss_all(struct tinywl_toplevel *toplevel) {
+  /* Destroying a popup dismisses its children first, and ends the grab of
+   * the topmost one */
+  struct wlr_xdg_popup *popup, *tmp;
+  wl_list_for_each_safe(popup, tmp, &toplevel->xdg_toplevel->base->popups,
+                        link) {
+    wlr_xdg_popup_destroy(popup);
+  }
+}
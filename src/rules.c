@@ -0,0 +1,162 @@
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "config.h"
+#include "rules.h"
+
+static uint32_t hash_string(const char *str) {
+  /* FNV-1a */
+  uint32_t hash = 2166136261u;
+  for (; *str != '\0'; str++) {
+    hash = (hash ^ (unsigned char)*str) * 16777619u;
+  }
+  return hash;
+}
+
+static struct tinywl_rule_bucket *find_bucket(struct tinywl_rules *rules,
+                                              const char *app_id,
+                                              uint32_t hash) {
+  /* Linear probing, the table is never more than half full */
+  size_t mask = rules->bucket_count - 1;
+  for (size_t i = hash & mask;; i = (i + 1) & mask) {
+    struct tinywl_rule_bucket *bucket = &rules->buckets[i];
+    if (bucket->app_id == NULL ||
+        (bucket->hash == hash && strcmp(bucket->app_id, app_id) == 0)) {
+      return bucket;
+    }
+  }
+}
+
+void rules_init(struct tinywl_server *server) {
+  struct tinywl_rules *rules = calloc(1, sizeof(*rules));
+  const window_rule *table = get_rules();
+  rules->rules = calloc(RULES_COUNT, sizeof(*rules->rules));
+  rules->any = calloc(RULES_COUNT, sizeof(*rules->any));
+  rules->bucket_count = 1;
+  while (rules->bucket_count < 2 * RULES_COUNT) {
+    rules->bucket_count *= 2;
+  }
+  rules->buckets = calloc(rules->bucket_count, sizeof(*rules->buckets));
+
+  for (size_t i = 0; i < RULES_COUNT; i++) {
+    const window_rule *rule = &table[i];
+    struct tinywl_compiled_rule *compiled = &rules->rules[rules->count];
+    if (rule->title != NULL) {
+      int err = regcomp(&compiled->title, rule->title, REG_EXTENDED | REG_NOSUB);
+      if (err != 0) {
+        char message[256];
+        regerror(err, &compiled->title, message, sizeof(message));
+        wlr_log(WLR_ERROR, "Skipping window rule %zu, bad title '%s': %s", i,
+                rule->title, message);
+        continue;
+      }
+      compiled->has_title = true;
+    }
+    compiled->rule = rule;
+    size_t index = rules->count++;
+
+    if (rule->app_id == NULL) {
+      rules->any[rules->any_count++] = index;
+      continue;
+    }
+    uint32_t hash = hash_string(rule->app_id);
+    struct tinywl_rule_bucket *bucket = find_bucket(rules, rule->app_id, hash);
+    if (bucket->app_id == NULL) {
+      bucket->app_id = rule->app_id;
+      bucket->hash = hash;
+    }
+    bucket->rules =
+        realloc(bucket->rules, (bucket->count + 1) * sizeof(*bucket->rules));
+    bucket->rules[bucket->count++] = index;
+  }
+  server->rules = rules;
+}
+
+void rules_finish(struct tinywl_server *server) {
+  struct tinywl_rules *rules = server->rules;
+  if (rules == NULL) {
+    return;
+  }
+  for (size_t i = 0; i < rules->count; i++) {
+    if (rules->rules[i].has_title) {
+      regfree(&rules->rules[i].title);
+    }
+  }
+  for (size_t i = 0; i < rules->bucket_count; i++) {
+    free(rules->buckets[i].rules);
+  }
+  free(rules->buckets);
+  free(rules->any);
+  free(rules->rules);
+  free(rules);
+  server->rules = NULL;
+}
+
+static void apply_rule(const window_rule *rule,
+                       struct tinywl_rule_result *result) {
+  if (rule->floating != RULE_UNSET) {
+    result->floating = rule->floating;
+  }
+  if (rule->workspace > 0) {
+    result->workspace = rule->workspace;
+  }
+  if (rule->width > 0 && rule->height > 0) {
+    result->width = rule->width;
+    result->height = rule->height;
+  }
+  if (rule->border != RULE_UNSET) {
+    result->border = rule->border;
+  }
+  if (rule->throttle != RULE_UNSET) {
+    result->throttle = rule->throttle;
+  }
+  if (rule->client_decorations != RULE_UNSET) {
+    result->client_decorations = rule->client_decorations;
+  }
+}
+
+void rules_match(struct tinywl_server *server, const char *app_id,
+                 const char *title, struct tinywl_rule_result *result) {
+  struct tinywl_rules *rules = server->rules;
+  *result = (struct tinywl_rule_result){0};
+
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  const size_t *named = NULL;
+  size_t named_count = 0;
+  if (app_id != NULL) {
+    struct tinywl_rule_bucket *bucket =
+        find_bucket(rules, app_id, hash_string(app_id));
+    named = bucket->rules;
+    named_count = bucket->count;
+  }
+
+  /* Merge both lists of candidates back into table order */
+  size_t matched = 0;
+  size_t i = 0, j = 0;
+  while (i < named_count || j < rules->any_count) {
+    size_t index;
+    if (j == rules->any_count ||
+        (i < named_count && named[i] < rules->any[j])) {
+      index = named[i++];
+    } else {
+      index = rules->any[j++];
+    }
+    struct tinywl_compiled_rule *compiled = &rules->rules[index];
+    if (compiled->has_title &&
+        (title == NULL || regexec(&compiled->title, title, 0, NULL, 0) != 0)) {
+      continue;
+    }
+    apply_rule(compiled->rule, result);
+    matched++;
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  long elapsed_ns = (end.tv_sec - start.tv_sec) * 1000000000L +
+                    (end.tv_nsec - start.tv_nsec);
+  wlr_log(WLR_DEBUG, "Window rules: %zu of %zu candidates matched '%s' in %ld ns",
+          matched, named_count + rules->any_count,
+          app_id != NULL ? app_id : "", elapsed_ns);
+}
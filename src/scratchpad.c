@@ -0,0 +1,126 @@
+#include "cursor.h"
+#include "layout.h"
+#include "output.h"
+#include "overview.h"
+#include "scratchpad.h"
+#include "switcher.h"
+#include "toplevel.h"
+#include "transaction.h"
+#include "utils.h"
+#include "workspace.h"
+
+void toplevel_hide(struct tinywl_toplevel *toplevel) {
+  struct tinywl_workspace *workspace = toplevel->workspace;
+  if (toplevel->hidden || workspace == NULL) {
+    return;
+  }
+  struct tinywl_server *server = toplevel->server;
+  if (toplevel == server->grabbed_toplevel) {
+    reset_cursor_mode(server);
+  }
+  switcher_toplevel_unmap(toplevel);
+  overview_toplevel_unmap(toplevel);
+  bool focused = get_focused_toplevel(server) == toplevel;
+
+  toplevel->hidden = true;
+  toplevel->hidden_tiled = toplevel->container != NULL;
+  transaction_remove_toplevel(toplevel);
+  workspace_remove_toplevel(toplevel);
+  wlr_scene_node_set_enabled(&toplevel->scene_tree->node, false);
+
+  /* The remaining tiles take the window's space */
+  transaction_commit(server);
+  if (focused) {
+    focus_workspace(workspace);
+  }
+}
+
+void toplevel_unhide(struct tinywl_toplevel *toplevel,
+                     struct tinywl_workspace *workspace) {
+  if (!toplevel->hidden) {
+    return;
+  }
+  toplevel->hidden = false;
+  struct wlr_scene_node *node = &toplevel->scene_tree->node;
+  bool tile = toplevel->hidden_tiled && !toplevel->scratchpad;
+
+  if (tile) {
+    /* Stay hidden until the transaction puts the window in its new tile,
+     * and make sure the layout sends the window its size */
+    toplevel->awaiting_placement = true;
+    toplevel->tile = (struct wlr_box){0};
+  } else {
+    /* Center the window unless it is already on the output */
+    struct wlr_box *area = &workspace->output->usable_area;
+    struct wlr_box *geo_box = &toplevel->xdg_toplevel->base->geometry;
+    if (toplevel->scratchpad || !wlr_box_contains_point(area, node->x, node->y)) {
+      wlr_scene_node_set_position(node,
+                                  area->x + (area->width - geo_box->width) / 2,
+                                  area->y + (area->height - geo_box->height) / 2);
+    }
+    wlr_scene_node_set_enabled(node, true);
+  }
+  workspace_add_toplevel(workspace, toplevel, tile);
+  if (toplevel->maximized) {
+    /* Fit the window to the usable area of its new output */
+    toplevel_set_maximized(toplevel, true);
+  }
+  transaction_commit(toplevel->server);
+  focus_toplevel(toplevel);
+}
+
+static struct tinywl_workspace *current_workspace(struct tinywl_server *server) {
+  struct tinywl_output *output =
+      output_at(server, server->cursor->x, server->cursor->y);
+  return output != NULL ? output->active_workspace : NULL;
+}
+
+static struct tinywl_toplevel *find_hidden(struct tinywl_server *server,
+                                           bool scratchpad) {
+  /* server->toplevels is in MRU order */
+  struct tinywl_toplevel *toplevel;
+  wl_list_for_each(toplevel, &server->toplevels, link) {
+    if (toplevel->hidden && toplevel->scratchpad == scratchpad) {
+      return toplevel;
+    }
+  }
+  return NULL;
+}
+
+void minimize_focused(struct tinywl_server *server) {
+  struct tinywl_toplevel *toplevel = get_focused_toplevel(server);
+  if (toplevel != NULL) {
+    toplevel_hide(toplevel);
+  }
+}
+
+void restore_minimized(struct tinywl_server *server) {
+  struct tinywl_workspace *workspace = current_workspace(server);
+  struct tinywl_toplevel *toplevel = find_hidden(server, false);
+  if (workspace != NULL && toplevel != NULL) {
+    toplevel_unhide(toplevel, workspace);
+  }
+}
+
+void scratchpad_move_focused(struct tinywl_server *server) {
+  struct tinywl_toplevel *toplevel = get_focused_toplevel(server);
+  if (toplevel == NULL) {
+    return;
+  }
+  toplevel->scratchpad = true;
+  workspace_set_floating(toplevel, true);
+  toplevel_hide(toplevel);
+}
+
+void scratchpad_toggle(struct tinywl_server *server) {
+  struct tinywl_toplevel *focused = get_focused_toplevel(server);
+  if (focused != NULL && focused->scratchpad) {
+    toplevel_hide(focused);
+    return;
+  }
+  struct tinywl_workspace *workspace = current_workspace(server);
+  struct tinywl_toplevel *toplevel = find_hidden(server, true);
+  if (workspace != NULL && toplevel != NULL) {
+    toplevel_unhide(toplevel, workspace);
+  }
+}
@@ -18,6 +18,7 @@ void seat_request_cursor(struct wl_listener *listener, void *data) {
      * cursor moves between outputs. */
     wlr_cursor_set_surface(server->cursor, event->surface, event->hotspot_x,
                            event->hotspot_y);
+    server->cursor_default = false;
   }
 }
 
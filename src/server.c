@@ -1,22 +1,39 @@
+#include "occlusion.h"
+#include "output.h"
+#include "rules.h"
 #include "server.h"
+#include "session.h"
+#include "thumbnail.h"
+#include "transaction.h"
 
 void server_cleanup(struct tinywl_server *server) {
   wl_display_destroy_clients(server->wl_display);
 
   wl_list_remove(&server->new_xdg_toplevel.link);
   wl_list_remove(&server->new_xdg_popup.link);
+  wl_list_remove(&server->new_toplevel_decoration.link);
 
   wl_list_remove(&server->cursor_motion.link);
   wl_list_remove(&server->cursor_motion_absolute.link);
   wl_list_remove(&server->cursor_button.link);
   wl_list_remove(&server->cursor_axis.link);
   wl_list_remove(&server->cursor_frame.link);
+  wl_event_source_remove(server->focus_timer);
+  wl_event_source_remove(server->resize_timer);
 
   wl_list_remove(&server->new_input.link);
   wl_list_remove(&server->request_cursor.link);
   wl_list_remove(&server->request_set_selection.link);
 
   wl_list_remove(&server->new_output.link);
+  wl_list_remove(&server->output_layout_change.link);
+
+  session_finish(server);
+  transaction_finish(server);
+  occlusion_finish(server);
+  thumbnail_finish(server);
+  rules_finish(server);
+  output_saved_finish(server);
 
   wlr_scene_node_destroy(&server->scene->tree.node);
   wlr_xcursor_manager_destroy(server->cursor_mgr);
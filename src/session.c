@@ -0,0 +1,525 @@
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "layout.h"
+#include "output.h"
+#include "session.h"
+#include "toplevel.h"
+#include "transaction.h"
+#include "workspace.h"
+
+/* Deepest tiling tree read from the session file */
+#define SESSION_MAX_DEPTH 32
+
+static const char layout_names[] = "hvts";
+
+struct parse_state {
+  struct tinywl_container *stack[SESSION_MAX_DEPTH];
+  int active[SESSION_MAX_DEPTH];
+  int count[SESSION_MAX_DEPTH];
+};
+
+static bool session_path(char *path, size_t size) {
+  const char *state = getenv("XDG_STATE_HOME");
+  int len;
+  if (state != NULL && state[0] == '/') {
+    len = snprintf(path, size, "%s/%s", state, SESSION_FILE);
+  } else {
+    const char *home = getenv("HOME");
+    if (home == NULL) {
+      return false;
+    }
+    len = snprintf(path, size, "%s/.local/state/%s", home, SESSION_FILE);
+  }
+  return len > 0 && (size_t)len < size;
+}
+
+static void make_parent_dirs(char *path) {
+  for (char *slash = strchr(path + 1, '/'); slash != NULL;
+       slash = strchr(slash + 1, '/')) {
+    *slash = '\0';
+    if (mkdir(path, 0700) != 0 && errno != EEXIST) {
+      wlr_log_errno(WLR_ERROR, "Can't create %s", path);
+    }
+    *slash = '/';
+  }
+}
+
+static void slot_destroy(struct tinywl_session_slot *slot) {
+  /* Unless a window filled it, the placeholder's space is given up */
+  if (slot->placeholder != NULL) {
+    layout_remove_placeholder(slot->placeholder);
+  }
+  wl_list_remove(&slot->link);
+  free(slot->app_id);
+  free(slot);
+}
+
+static void saved_output_destroy(struct tinywl_session_output *saved) {
+  for (int i = 0; i < WORKSPACE_COUNT; i++) {
+    layout_saved_destroy(saved->trees[i]);
+  }
+  struct tinywl_session_slot *slot, *tmp;
+  wl_list_for_each_safe(slot, tmp, &saved->floating, link) {
+    slot_destroy(slot);
+  }
+  wl_list_remove(&saved->link);
+  free(saved->name);
+  free(saved);
+}
+
+static struct tinywl_container *parse_add(struct parse_state *state, int depth,
+                                          enum tinywl_container_layout layout,
+                                          double weight, const char *app_id) {
+  struct tinywl_container *parent = depth > 0 ? state->stack[depth - 1] : NULL;
+  struct tinywl_container *container =
+      layout_saved_add(parent, layout, weight > 0 ? weight : 1.0, app_id);
+  if (parent != NULL && state->count[depth - 1]++ == state->active[depth - 1]) {
+    parent->active = container;
+  }
+  /* Only a split can be the parent of the lines that follow */
+  for (int i = depth; i < SESSION_MAX_DEPTH; i++) {
+    state->stack[i] = NULL;
+  }
+  if (app_id == NULL) {
+    state->stack[depth] = container;
+    state->count[depth] = 0;
+  }
+  return container;
+}
+
+static bool session_parse(struct tinywl_session *session, FILE *file) {
+  char *line = NULL;
+  size_t size = 0;
+  if (getline(&line, &size, file) < 0 ||
+      strcmp(line, "nocturne-session 1\n") != 0) {
+    free(line);
+    return false;
+  }
+
+  struct tinywl_session_output *output = NULL;
+  int workspace = -1;
+  struct parse_state state = {0};
+  while (getline(&line, &size, file) >= 0) {
+    line[strcspn(line, "\n")] = '\0';
+    char name[64], layout;
+    int depth, active, x, y, width, height, maximized, app_id = 0;
+    double weight;
+
+    if (sscanf(line, "output %63s %d", name, &active) == 2) {
+      output = calloc(1, sizeof(*output));
+      output->name = strdup(name);
+      output->active_workspace =
+          active >= 0 && active < WORKSPACE_COUNT ? active : 0;
+      wl_list_init(&output->floating);
+      wl_list_insert(session->outputs.prev, &output->link);
+      workspace = -1;
+    } else if (output == NULL) {
+      continue;
+    } else if (sscanf(line, "workspace %d", &workspace) == 1) {
+      if (workspace < 0 || workspace >= WORKSPACE_COUNT ||
+          output->trees[workspace] != NULL) {
+        workspace = -1;
+      }
+      state = (struct parse_state){0};
+    } else if (workspace >= 0 &&
+               sscanf(line, "split %d %c %lf %d", &depth, &layout, &weight,
+                      &active) == 4) {
+      const char *known = strchr(layout_names, layout);
+      if (known == NULL || layout == '\0' || depth < 0 ||
+          depth >= SESSION_MAX_DEPTH ||
+          (depth == 0) != (output->trees[workspace] == NULL) ||
+          (depth > 0 && state.stack[depth - 1] == NULL)) {
+        continue;
+      }
+      struct tinywl_container *split =
+          parse_add(&state, depth,
+                    (enum tinywl_container_layout)(known - layout_names),
+                    weight, NULL);
+      state.active[depth] = active;
+      if (depth == 0) {
+        output->trees[workspace] = split;
+      }
+    } else if (workspace >= 0 &&
+               sscanf(line, "leaf %d %lf %n", &depth, &weight, &app_id) == 2 &&
+               app_id > 0 && line[app_id] != '\0') {
+      if (depth < 1 || depth >= SESSION_MAX_DEPTH ||
+          state.stack[depth - 1] == NULL) {
+        continue;
+      }
+      parse_add(&state, depth, TINYWL_LAYOUT_SPLIT_H, weight, line + app_id);
+    } else if (sscanf(line, "floating %d %d %d %d %d %d %n", &active, &x, &y,
+                      &width, &height, &maximized, &app_id) == 6 &&
+               app_id > 0 && line[app_id] != '\0') {
+      if (active < 0 || active >= WORKSPACE_COUNT || width <= 0 ||
+          height <= 0) {
+        continue;
+      }
+      struct tinywl_session_slot *slot = calloc(1, sizeof(*slot));
+      slot->app_id = strdup(line + app_id);
+      slot->workspace_index = active;
+      slot->box = (struct wlr_box){x, y, width, height};
+      slot->maximized = maximized != 0;
+      wl_list_insert(output->floating.prev, &slot->link);
+    }
+  }
+  free(line);
+  return true;
+}
+
+static int session_timeout(void *data) {
+  struct tinywl_server *server = data;
+  struct tinywl_session *session = server->session;
+  session->expired = true;
+
+  /* Windows that claimed a place still get it when they map */
+  transaction_begin_batch(server);
+  struct tinywl_session_slot *slot, *slot_tmp;
+  wl_list_for_each_safe(slot, slot_tmp, &session->slots, link) {
+    if (slot->toplevel == NULL) {
+      slot_destroy(slot);
+    }
+  }
+  transaction_end_batch(server);
+
+  struct tinywl_session_output *saved, *saved_tmp;
+  wl_list_for_each_safe(saved, saved_tmp, &session->outputs, link) {
+    saved_output_destroy(saved);
+  }
+  return 0;
+}
+
+void session_init(struct tinywl_server *server) {
+  if (!SESSION_RESTORE) {
+    return;
+  }
+  char path[PATH_MAX];
+  if (!session_path(path, sizeof(path))) {
+    return;
+  }
+  FILE *file = fopen(path, "r");
+  if (file == NULL) {
+    return;
+  }
+
+  struct tinywl_session *session = calloc(1, sizeof(*session));
+  wl_list_init(&session->outputs);
+  wl_list_init(&session->slots);
+  if (!session_parse(session, file)) {
+    wlr_log(WLR_ERROR, "Ignoring session file %s, unknown format", path);
+  }
+  fclose(file);
+
+  session->timeout = wl_event_loop_add_timer(
+      wl_display_get_event_loop(server->wl_display), session_timeout, server);
+  wl_event_source_timer_update(session->timeout, SESSION_RESTORE_TIMEOUT_MS);
+  server->session = session;
+}
+
+void session_finish(struct tinywl_server *server) {
+  struct tinywl_session *session = server->session;
+  if (session == NULL) {
+    return;
+  }
+  struct tinywl_session_slot *slot, *slot_tmp;
+  wl_list_for_each_safe(slot, slot_tmp, &session->slots, link) {
+    if (slot->toplevel != NULL) {
+      slot->toplevel->session_slot = NULL;
+    }
+    slot_destroy(slot);
+  }
+  struct tinywl_session_output *saved, *saved_tmp;
+  wl_list_for_each_safe(saved, saved_tmp, &session->outputs, link) {
+    saved_output_destroy(saved);
+  }
+  wl_event_source_remove(session->timeout);
+  free(session);
+  server->session = NULL;
+}
+
+static void save_container(FILE *file, struct tinywl_container *container,
+                           int depth) {
+  if (container->toplevel != NULL || container->placeholder != NULL) {
+    /* Places still waiting for their window are kept as well */
+    const char *app_id = container->toplevel != NULL
+                             ? container->toplevel->xdg_toplevel->app_id
+                             : container->placeholder;
+    if (app_id != NULL && app_id[0] != '\0') {
+      fprintf(file, "leaf %d %.3f %s\n", depth, container->weight, app_id);
+    }
+    return;
+  }
+
+  int active = -1, index = 0;
+  struct tinywl_container *child;
+  wl_list_for_each(child, &container->children, link) {
+    if (child == container->active) {
+      active = index;
+    }
+    index++;
+  }
+  fprintf(file, "split %d %c %.3f %d\n", depth, layout_names[container->layout],
+          container->weight, active);
+  if (depth + 1 < SESSION_MAX_DEPTH) {
+    wl_list_for_each(child, &container->children, link) {
+      save_container(file, child, depth + 1);
+    }
+  }
+}
+
+static void save_output(FILE *file, struct tinywl_output *output) {
+  struct tinywl_server *server = output->server;
+  fprintf(file, "output %s %d\n", output->wlr_output->name,
+          output->active_workspace->index);
+  for (int i = 0; i < WORKSPACE_COUNT; i++) {
+    struct tinywl_container *root = output->workspaces[i].root;
+    if (!wl_list_empty(&root->children)) {
+      fprintf(file, "workspace %d\n", i);
+      save_container(file, root, 0);
+    }
+  }
+
+  /* Bottom of the stack first, so the windows are claimed in that order */
+  struct wlr_box output_box;
+  wlr_output_layout_get_box(server->output_layout, output->wlr_output,
+                            &output_box);
+  struct tinywl_toplevel *toplevel;
+  wl_list_for_each_reverse(toplevel, &server->toplevels, link) {
+    const char *app_id = toplevel->xdg_toplevel->app_id;
+    if (toplevel->workspace == NULL || toplevel->workspace->output != output ||
+        toplevel->container != NULL || app_id == NULL || app_id[0] == '\0') {
+      continue;
+    }
+    struct wlr_box *geo_box = &toplevel->xdg_toplevel->base->geometry;
+    struct wlr_box box = toplevel->maximized
+                             ? toplevel->floating_box
+                             : (struct wlr_box){
+                                   .x = toplevel->scene_tree->node.x,
+                                   .y = toplevel->scene_tree->node.y,
+                                   .width = geo_box->width,
+                                   .height = geo_box->height,
+                               };
+    fprintf(file, "floating %d %d %d %d %d %d %s\n",
+            toplevel->workspace->index, box.x - output_box.x,
+            box.y - output_box.y, box.width, box.height, toplevel->maximized,
+            app_id);
+  }
+}
+
+void session_save(struct tinywl_server *server) {
+  if (!SESSION_RESTORE) {
+    return;
+  }
+  char path[PATH_MAX], tmp_path[PATH_MAX + 4];
+  if (!session_path(path, sizeof(path))) {
+    return;
+  }
+  make_parent_dirs(path);
+  snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+  FILE *file = fopen(tmp_path, "w");
+  if (file == NULL) {
+    wlr_log_errno(WLR_ERROR, "Can't write session file %s", tmp_path);
+    return;
+  }
+
+  fprintf(file, "nocturne-session 1\n");
+  struct tinywl_output *output;
+  wl_list_for_each(output, &server->outputs, link) {
+    save_output(file, output);
+  }
+
+  /* Written next to the old file and renamed over it, a crash never leaves
+   * half a session behind */
+  bool failed = fflush(file) != 0 || ferror(file);
+  if (fclose(file) != 0 || failed || rename(tmp_path, path) != 0) {
+    wlr_log_errno(WLR_ERROR, "Can't write session file %s", path);
+    unlink(tmp_path);
+  }
+}
+
+static void add_placeholder_slots(struct tinywl_session *session,
+                                  struct tinywl_workspace *workspace,
+                                  struct tinywl_container *container) {
+  if (container->placeholder != NULL) {
+    struct tinywl_session_slot *slot = calloc(1, sizeof(*slot));
+    slot->app_id = strdup(container->placeholder);
+    slot->workspace = workspace;
+    slot->workspace_index = workspace->index;
+    slot->placeholder = container;
+    wl_list_insert(session->slots.prev, &slot->link);
+    return;
+  }
+  struct tinywl_container *child;
+  wl_list_for_each(child, &container->children, link) {
+    add_placeholder_slots(session, workspace, child);
+  }
+}
+
+void session_restore_output(struct tinywl_output *output) {
+  struct tinywl_server *server = output->server;
+  struct tinywl_session *session = server->session;
+  if (session == NULL) {
+    return;
+  }
+  struct tinywl_session_output *saved = NULL, *candidate;
+  wl_list_for_each(candidate, &session->outputs, link) {
+    if (strcmp(candidate->name, output->wlr_output->name) == 0) {
+      saved = candidate;
+      break;
+    }
+  }
+  if (saved == NULL) {
+    return;
+  }
+
+  /* Every tree is arranged once with all of its placeholders */
+  transaction_begin_batch(server);
+  for (int i = 0; i < WORKSPACE_COUNT; i++) {
+    struct tinywl_workspace *workspace = &output->workspaces[i];
+    if (saved->trees[i] == NULL ||
+        !wl_list_empty(&workspace->root->children)) {
+      continue;
+    }
+    layout_restore(workspace->root, saved->trees[i]);
+    saved->trees[i] = NULL;
+    add_placeholder_slots(session, workspace, workspace->root);
+  }
+  transaction_end_batch(server);
+
+  struct tinywl_session_slot *slot, *tmp;
+  wl_list_for_each_safe(slot, tmp, &saved->floating, link) {
+    slot->workspace = &output->workspaces[slot->workspace_index];
+    wl_list_remove(&slot->link);
+    wl_list_insert(session->slots.prev, &slot->link);
+  }
+
+  workspace_show(&output->workspaces[saved->active_workspace]);
+  saved_output_destroy(saved);
+}
+
+void session_output_destroy(struct tinywl_output *output) {
+  struct tinywl_server *server = output->server;
+  struct tinywl_session *session = server->session;
+  if (session == NULL) {
+    return;
+  }
+
+  transaction_begin_batch(server);
+  struct tinywl_session_slot *slot, *tmp;
+  wl_list_for_each_safe(slot, tmp, &session->slots, link) {
+    if (slot->workspace->output != output) {
+      continue;
+    }
+    struct tinywl_toplevel *toplevel = slot->toplevel;
+    if (toplevel != NULL) {
+      /* The window was sent a size for this output, it is placed like any
+       * new window instead */
+      toplevel->session_slot = NULL;
+      toplevel->maximized = false;
+      toplevel->tile = (struct wlr_box){0};
+    }
+    slot_destroy(slot);
+  }
+  transaction_end_batch(server);
+}
+
+bool session_claim(struct tinywl_toplevel *toplevel) {
+  struct tinywl_session *session = toplevel->server->session;
+  const char *app_id = toplevel->xdg_toplevel->app_id;
+  struct tinywl_session_slot *slot = toplevel->session_slot;
+  if (slot == NULL) {
+    if (session == NULL || app_id == NULL) {
+      return false;
+    }
+    struct tinywl_session_slot *candidate;
+    wl_list_for_each(candidate, &session->slots, link) {
+      if (candidate->toplevel == NULL &&
+          strcmp(candidate->app_id, app_id) == 0) {
+        slot = candidate;
+        break;
+      }
+    }
+    if (slot == NULL) {
+      return false;
+    }
+    slot->toplevel = toplevel;
+    toplevel->session_slot = slot;
+  }
+
+  struct wlr_xdg_toplevel *xdg_toplevel = toplevel->xdg_toplevel;
+  if (slot->placeholder != NULL) {
+    toplevel_preset_tile(toplevel, &slot->placeholder->box);
+  } else if (slot->maximized) {
+    /* Already maximized when it maps, see session_place() */
+    struct wlr_box *area = &slot->workspace->output->usable_area;
+    wlr_xdg_toplevel_set_maximized(xdg_toplevel, true);
+    wlr_xdg_toplevel_set_size(xdg_toplevel, area->width, area->height);
+    toplevel->maximized = true;
+    toplevel->tile = *area;
+  } else {
+    wlr_xdg_toplevel_set_size(xdg_toplevel, slot->box.width,
+                              slot->box.height);
+  }
+  return true;
+}
+
+struct tinywl_workspace *session_place(struct tinywl_toplevel *toplevel) {
+  struct tinywl_session_slot *slot = toplevel->session_slot;
+  if (slot == NULL) {
+    return NULL;
+  }
+  toplevel->session_slot = NULL;
+  struct tinywl_workspace *workspace = slot->workspace;
+  struct wlr_scene_node *node = &toplevel->scene_tree->node;
+
+  if (slot->placeholder != NULL) {
+    /* Hidden until the transaction puts it in its tile. The client already
+     * has the tile's size, so nothing is waited on unless the tile changed
+     * in the meantime. */
+    wlr_scene_node_set_enabled(node, false);
+    toplevel->awaiting_placement = true;
+    workspace_fill_placeholder(workspace, toplevel, slot->placeholder);
+    slot->placeholder = NULL;
+  } else {
+    struct tinywl_server *server = toplevel->server;
+    struct wlr_box output_box;
+    wlr_output_layout_get_box(server->output_layout,
+                              workspace->output->wlr_output, &output_box);
+    struct wlr_box box = slot->box;
+    box.x += output_box.x;
+    box.y += output_box.y;
+    if (toplevel->maximized) {
+      toplevel->floating_box = box;
+      box = toplevel->tile;
+    }
+    wlr_scene_node_set_position(node, box.x, box.y);
+    workspace_add_toplevel(workspace, toplevel, false);
+    if (toplevel->maximized) {
+      /* Refits the window if the usable area changed since it claimed */
+      toplevel_set_maximized(toplevel, true);
+      transaction_commit(server);
+    }
+  }
+
+  slot_destroy(slot);
+  return workspace;
+}
+
+void session_release(struct tinywl_toplevel *toplevel) {
+  struct tinywl_session_slot *slot = toplevel->session_slot;
+  if (slot == NULL) {
+    return;
+  }
+  toplevel->session_slot = NULL;
+  /* Another window with the same app_id may still take the place */
+  if (toplevel->server->session->expired) {
+    slot_destroy(slot);
+  } else {
+    slot->toplevel = NULL;
+  }
+}
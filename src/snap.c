@@ -0,0 +1,99 @@
+#include <stdlib.h>
+
+#include "config.h"
+#include "output.h"
+#include "snap.h"
+#include "toplevel.h"
+#include "workspace.h"
+
+static int compare_int(const void *a, const void *b) {
+  int x = *(const int *)a, y = *(const int *)b;
+  return (x > y) - (x < y);
+}
+
+static void add_box(struct tinywl_snap_index *index, const struct wlr_box *box) {
+  index->x_edges[index->x_count++] = box->x;
+  index->x_edges[index->x_count++] = box->x + box->width;
+  index->y_edges[index->y_count++] = box->y;
+  index->y_edges[index->y_count++] = box->y + box->height;
+}
+
+struct tinywl_snap_index *snap_index_create(struct tinywl_server *server,
+                                            struct tinywl_toplevel *skip) {
+  size_t boxes = wl_list_length(&server->outputs) +
+                 wl_list_length(&server->toplevels);
+  struct tinywl_snap_index *index = calloc(1, sizeof(*index));
+  index->x_edges = calloc(2 * boxes, sizeof(*index->x_edges));
+  index->y_edges = calloc(2 * boxes, sizeof(*index->y_edges));
+
+  struct tinywl_output *output;
+  wl_list_for_each(output, &server->outputs, link) {
+    add_box(index, &output->usable_area);
+  }
+
+  /* Only windows that can be seen, including their borders */
+  struct tinywl_toplevel *toplevel;
+  wl_list_for_each(toplevel, &server->toplevels, link) {
+    struct tinywl_workspace *workspace = toplevel->workspace;
+    if (toplevel == skip || workspace == NULL ||
+        workspace->output->active_workspace != workspace ||
+        !toplevel->scene_tree->node.enabled) {
+      continue;
+    }
+    struct wlr_box *geo_box = &toplevel->xdg_toplevel->base->geometry;
+    struct wlr_box box = {
+        .x = toplevel->scene_tree->node.x - BORDER_WIDTH,
+        .y = toplevel->scene_tree->node.y - BORDER_WIDTH,
+        .width = geo_box->width + 2 * BORDER_WIDTH,
+        .height = geo_box->height + 2 * BORDER_WIDTH,
+    };
+    add_box(index, &box);
+  }
+
+  qsort(index->x_edges, index->x_count, sizeof(int), compare_int);
+  qsort(index->y_edges, index->y_count, sizeof(int), compare_int);
+  return index;
+}
+
+void snap_index_destroy(struct tinywl_snap_index *index) {
+  if (index == NULL) {
+    return;
+  }
+  free(index->x_edges);
+  free(index->y_edges);
+  free(index);
+}
+
+static void nearest_edge(const int *edges, size_t count, int value,
+                         int *best_offset, int *best_dist) {
+  /* Binary search for the first edge at or after value, the nearest edge is
+   * either that one or the one before it */
+  size_t lo = 0, hi = count;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (edges[mid] < value) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  for (size_t i = lo > 0 ? lo - 1 : 0; i < count && i <= lo; i++) {
+    int dist = abs(edges[i] - value);
+    if (dist < *best_dist) {
+      *best_dist = dist;
+      *best_offset = edges[i] - value;
+    }
+  }
+}
+
+static int snap_axis(const int *edges, size_t count, int start, int size) {
+  int offset = 0, dist = SNAP_THRESHOLD + 1;
+  nearest_edge(edges, count, start, &offset, &dist);
+  nearest_edge(edges, count, start + size, &offset, &dist);
+  return dist <= SNAP_THRESHOLD ? start + offset : start;
+}
+
+void snap_box(const struct tinywl_snap_index *index, struct wlr_box *box) {
+  box->x = snap_axis(index->x_edges, index->x_count, box->x, box->width);
+  box->y = snap_axis(index->y_edges, index->y_count, box->y, box->height);
+}
@@ -0,0 +1,82 @@
+#include <stdlib.h>
+
+#include "snapshot.h"
+
+static void count_iterator(struct wlr_scene_buffer *buffer, int sx, int sy,
+                           void *user_data) {
+  (void)sx; // coordinates are unused here
+  (void)sy;
+  size_t *count = user_data;
+  if (buffer->buffer != NULL) {
+    (*count)++;
+  }
+}
+
+static void copy_iterator(struct wlr_scene_buffer *buffer, int sx, int sy,
+                          void *user_data) {
+  struct tinywl_snapshot *snapshot = user_data;
+  if (buffer->buffer == NULL) {
+    return;
+  }
+
+  struct wlr_scene_buffer *copy =
+      wlr_scene_buffer_create(snapshot->tree, buffer->buffer);
+  wlr_scene_buffer_set_source_box(copy, &buffer->src_box);
+  wlr_scene_buffer_set_transform(copy, buffer->transform);
+  wlr_scene_buffer_set_opacity(copy, buffer->opacity);
+
+  /* A destination size of 0 means the buffer is shown at its own size */
+  struct tinywl_snapshot_buffer *entry =
+      &snapshot->buffers[snapshot->buffer_count++];
+  entry->scene_buffer = copy;
+  entry->box = (struct wlr_box){
+      .x = sx,
+      .y = sy,
+      .width = buffer->dst_width > 0 ? buffer->dst_width : buffer->buffer->width,
+      .height =
+          buffer->dst_height > 0 ? buffer->dst_height : buffer->buffer->height,
+  };
+  wlr_scene_node_set_position(&copy->node, sx, sy);
+  wlr_scene_buffer_set_dest_size(copy, entry->box.width, entry->box.height);
+}
+
+struct tinywl_snapshot *snapshot_create(struct wlr_scene_tree *parent,
+                                        struct wlr_scene_node *content,
+                                        int width, int height) {
+  struct tinywl_snapshot *snapshot = calloc(1, sizeof(*snapshot));
+  snapshot->tree = wlr_scene_tree_create(parent);
+  snapshot->width = width > 0 ? width : 1;
+  snapshot->height = height > 0 ? height : 1;
+
+  /* The iterator reports positions relative to the content node's parent,
+   * which is where the snapshot tree lives too */
+  size_t count = 0;
+  wlr_scene_node_for_each_buffer(content, count_iterator, &count);
+  snapshot->buffers = calloc(count, sizeof(*snapshot->buffers));
+  wlr_scene_node_for_each_buffer(content, copy_iterator, snapshot);
+  return snapshot;
+}
+
+void snapshot_scale(struct tinywl_snapshot *snapshot, int width, int height) {
+  double scale_x = (double)width / snapshot->width;
+  double scale_y = (double)height / snapshot->height;
+  for (size_t i = 0; i < snapshot->buffer_count; i++) {
+    struct tinywl_snapshot_buffer *entry = &snapshot->buffers[i];
+    int x = (int)(entry->box.x * scale_x);
+    int y = (int)(entry->box.y * scale_y);
+    int w = (int)((entry->box.x + entry->box.width) * scale_x) - x;
+    int h = (int)((entry->box.y + entry->box.height) * scale_y) - y;
+    wlr_scene_node_set_position(&entry->scene_buffer->node, x, y);
+    wlr_scene_buffer_set_dest_size(entry->scene_buffer, w > 0 ? w : 1,
+                                   h > 0 ? h : 1);
+  }
+}
+
+void snapshot_destroy(struct tinywl_snapshot *snapshot) {
+  if (snapshot == NULL) {
+    return;
+  }
+  wlr_scene_node_destroy(&snapshot->tree->node);
+  free(snapshot->buffers);
+  free(snapshot);
+}
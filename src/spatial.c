@@ -0,0 +1,231 @@
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "config.h"
+#include "output.h"
+#include "spatial.h"
+#include "toplevel.h"
+#include "workspace.h"
+
+static int clamp(int value, int min, int max) {
+  return value < min ? min : value > max ? max : value;
+}
+
+static uint64_t stack_key(struct tinywl_toplevel *toplevel) {
+  /* Floating windows are above every tiled window */
+  uint64_t floating = toplevel->container == NULL;
+  return floating << 63 | toplevel->stack_stamp;
+}
+
+static bool cell_range(const struct tinywl_spatial_grid *grid,
+                       const struct wlr_box *box, int *col_start,
+                       int *row_start, int *col_end, int *row_end) {
+  if (grid->cells == NULL || wlr_box_empty(box)) {
+    return false;
+  }
+  /* Anything beyond the grid's area lands in the edge cells */
+  *col_start = clamp((box->x - grid->area.x) / SPATIAL_CELL_SIZE, 0,
+                     grid->columns - 1);
+  *row_start = clamp((box->y - grid->area.y) / SPATIAL_CELL_SIZE, 0,
+                     grid->rows - 1);
+  *col_end = clamp((box->x + box->width - 1 - grid->area.x) / SPATIAL_CELL_SIZE,
+                   0, grid->columns - 1);
+  *row_end =
+      clamp((box->y + box->height - 1 - grid->area.y) / SPATIAL_CELL_SIZE, 0,
+            grid->rows - 1);
+  return true;
+}
+
+static void grid_insert(struct tinywl_spatial_grid *grid,
+                        struct tinywl_toplevel *toplevel,
+                        const struct wlr_box *box) {
+  int col_start, row_start, col_end, row_end;
+  if (!cell_range(grid, box, &col_start, &row_start, &col_end, &row_end)) {
+    return;
+  }
+  for (int row = row_start; row <= row_end; row++) {
+    for (int col = col_start; col <= col_end; col++) {
+      struct tinywl_spatial_cell *cell = &grid->cells[row * grid->columns + col];
+      if (cell->count == cell->capacity) {
+        cell->capacity = cell->capacity > 0 ? cell->capacity * 2 : 4;
+        cell->toplevels = realloc(cell->toplevels,
+                                  cell->capacity * sizeof(*cell->toplevels));
+      }
+      cell->toplevels[cell->count++] = toplevel;
+    }
+  }
+}
+
+static void grid_remove(struct tinywl_spatial_grid *grid,
+                        struct tinywl_toplevel *toplevel,
+                        const struct wlr_box *box) {
+  int col_start, row_start, col_end, row_end;
+  if (!cell_range(grid, box, &col_start, &row_start, &col_end, &row_end)) {
+    return;
+  }
+  for (int row = row_start; row <= row_end; row++) {
+    for (int col = col_start; col <= col_end; col++) {
+      struct tinywl_spatial_cell *cell = &grid->cells[row * grid->columns + col];
+      for (size_t i = 0; i < cell->count; i++) {
+        if (cell->toplevels[i] == toplevel) {
+          cell->toplevels[i] = cell->toplevels[--cell->count];
+          break;
+        }
+      }
+    }
+  }
+}
+
+void spatial_grid_finish(struct tinywl_spatial_grid *grid) {
+  for (int i = 0; i < grid->columns * grid->rows; i++) {
+    free(grid->cells[i].toplevels);
+  }
+  free(grid->cells);
+  *grid = (struct tinywl_spatial_grid){0};
+}
+
+void spatial_workspace_set_area(struct tinywl_workspace *workspace,
+                                const struct wlr_box *area) {
+  struct tinywl_spatial_grid *grid = &workspace->grid;
+  spatial_grid_finish(grid);
+  if (wlr_box_empty(area)) {
+    return;
+  }
+  grid->area = *area;
+  grid->columns = (area->width + SPATIAL_CELL_SIZE - 1) / SPATIAL_CELL_SIZE;
+  grid->rows = (area->height + SPATIAL_CELL_SIZE - 1) / SPATIAL_CELL_SIZE;
+  grid->cells = calloc(grid->columns * grid->rows, sizeof(*grid->cells));
+
+  struct tinywl_toplevel *toplevel;
+  wl_list_for_each(toplevel, &workspace->output->server->toplevels, link) {
+    if (toplevel->index_workspace == workspace) {
+      grid_insert(grid, toplevel, &toplevel->index_box);
+    }
+  }
+}
+
+static void bounds_iterator(struct wlr_scene_buffer *buffer, int sx, int sy,
+                            void *user_data) {
+  struct wlr_box *bounds = user_data;
+  int width = buffer->dst_width, height = buffer->dst_height;
+  if ((width <= 0 || height <= 0) && buffer->buffer != NULL) {
+    width = buffer->buffer->width;
+    height = buffer->buffer->height;
+  }
+  if (width <= 0 || height <= 0) {
+    return;
+  }
+
+  int x1 = bounds->x < sx ? bounds->x : sx;
+  int y1 = bounds->y < sy ? bounds->y : sy;
+  int x2 = bounds->x + bounds->width > sx + width ? bounds->x + bounds->width
+                                                  : sx + width;
+  int y2 = bounds->y + bounds->height > sy + height ? bounds->y + bounds->height
+                                                    : sy + height;
+  *bounds = (struct wlr_box){x1, y1, x2 - x1, y2 - y1};
+}
+
+void spatial_update_toplevel(struct tinywl_toplevel *toplevel) {
+  struct tinywl_workspace *workspace = toplevel->workspace;
+  if (workspace == NULL) {
+    spatial_remove_toplevel(toplevel);
+    return;
+  }
+
+  /* Start with the borders, then grow the box to cover every buffer. Buffer
+   * positions are relative to the layer, which is at the layout origin. */
+  struct wlr_scene_node *node = &toplevel->scene_tree->node;
+  struct wlr_box *geo_box = &toplevel->xdg_toplevel->base->geometry;
+  struct wlr_box box = {
+      .x = node->x - BORDER_WIDTH,
+      .y = node->y - BORDER_WIDTH,
+      .width = geo_box->width + 2 * BORDER_WIDTH,
+      .height = geo_box->height + 2 * BORDER_WIDTH,
+  };
+  wlr_scene_node_for_each_buffer(node, bounds_iterator, &box);
+
+  if (workspace == toplevel->index_workspace &&
+      wlr_box_equal(&box, &toplevel->index_box)) {
+    return;
+  }
+  spatial_remove_toplevel(toplevel);
+  grid_insert(&workspace->grid, toplevel, &box);
+  toplevel->index_box = box;
+  toplevel->index_workspace = workspace;
+}
+
+void spatial_remove_toplevel(struct tinywl_toplevel *toplevel) {
+  if (toplevel->index_workspace == NULL) {
+    return;
+  }
+  grid_remove(&toplevel->index_workspace->grid, toplevel,
+              &toplevel->index_box);
+  toplevel->index_workspace = NULL;
+}
+
+void spatial_raise_toplevel(struct tinywl_toplevel *toplevel) {
+  toplevel->stack_stamp = ++toplevel->server->stack_counter;
+}
+
+static struct tinywl_spatial_cell *
+grid_cell_at(struct tinywl_spatial_grid *grid, double lx, double ly) {
+  int col_start, row_start, col_end, row_end;
+  struct wlr_box point = {(int)lx, (int)ly, 1, 1};
+  if (!cell_range(grid, &point, &col_start, &row_start, &col_end, &row_end)) {
+    return NULL;
+  }
+  return &grid->cells[row_start * grid->columns + col_start];
+}
+
+struct tinywl_toplevel *spatial_toplevel_at(struct tinywl_server *server,
+                                            double lx, double ly,
+                                            struct wlr_surface **surface,
+                                            double *sx, double *sy) {
+  /* Each round picks the topmost candidate below the previous one, most
+   * lookups are settled by the first */
+  uint64_t below = UINT64_MAX;
+  for (;;) {
+    struct tinywl_toplevel *best = NULL;
+    uint64_t best_key = 0;
+    struct tinywl_output *output;
+    wl_list_for_each(output, &server->outputs, link) {
+      struct tinywl_spatial_cell *cell =
+          grid_cell_at(&output->active_workspace->grid, lx, ly);
+      if (cell == NULL) {
+        continue;
+      }
+      for (size_t i = 0; i < cell->count; i++) {
+        struct tinywl_toplevel *toplevel = cell->toplevels[i];
+        uint64_t key = stack_key(toplevel);
+        if (key >= below || (best != NULL && key <= best_key) ||
+            !toplevel->scene_tree->node.enabled ||
+            !wlr_box_contains_point(&toplevel->index_box, lx, ly)) {
+          continue;
+        }
+        best = toplevel;
+        best_key = key;
+      }
+    }
+    if (best == NULL) {
+      return NULL;
+    }
+    below = best_key;
+
+    /* Precise test, honoring input regions */
+    struct wlr_scene_node *node =
+        wlr_scene_node_at(&best->scene_tree->node, lx, ly, sx, sy);
+    if (node == NULL) {
+      continue;
+    }
+    if (node->type != WLR_SCENE_NODE_BUFFER) {
+      return NULL;
+    }
+    struct wlr_scene_surface *scene_surface =
+        wlr_scene_surface_try_from_buffer(wlr_scene_buffer_from_node(node));
+    if (scene_surface == NULL) {
+      return NULL;
+    }
+    *surface = scene_surface->surface;
+    return best;
+  }
+}
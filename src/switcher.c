@@ -0,0 +1,197 @@
+#include <stdlib.h>
+
+#include "config.h"
+#include "output.h"
+#include "switcher.h"
+#include "thumbnail.h"
+#include "toplevel.h"
+#include "utils.h"
+#include "workspace.h"
+
+static bool is_selectable(struct tinywl_toplevel *toplevel) {
+  struct tinywl_workspace *workspace = toplevel->workspace;
+  return workspace != NULL && workspace->output->active_workspace == workspace;
+}
+
+static void overlay_create(struct tinywl_server *server) {
+  struct tinywl_output *output =
+      output_at(server, server->cursor->x, server->cursor->y);
+  if (output == NULL || wlr_box_empty(&output->usable_area)) {
+    return;
+  }
+
+  /* As many cells as fit on the output, windows past that aren't shown and
+   * their thumbnails aren't rendered */
+  struct wlr_box *area = &output->usable_area;
+  int cell = THUMBNAIL_SIZE + 2 * SWITCHER_PADDING;
+  int max_columns = (area->width - 2 * SWITCHER_PADDING) / cell;
+  int max_rows = (area->height - 2 * SWITCHER_PADDING) / cell;
+  if (max_columns < 1 || max_rows < 1) {
+    return;
+  }
+  size_t count = 0;
+  struct tinywl_toplevel *toplevel;
+  wl_list_for_each(toplevel, &server->toplevels, link) {
+    if (is_selectable(toplevel)) {
+      count++;
+    }
+  }
+  if (count > (size_t)(max_columns * max_rows)) {
+    count = max_columns * max_rows;
+  }
+  if (count == 0) {
+    return;
+  }
+  int columns = count < (size_t)max_columns ? (int)count : max_columns;
+  int rows = ((int)count + columns - 1) / columns;
+
+  struct tinywl_switcher_overlay *overlay = calloc(1, sizeof(*overlay));
+  overlay->entries = calloc(count, sizeof(*overlay->entries));
+  overlay->tree = wlr_scene_tree_create(&server->scene->tree);
+  int width = columns * cell + 2 * SWITCHER_PADDING;
+  int height = rows * cell + 2 * SWITCHER_PADDING;
+  wlr_scene_node_set_position(&overlay->tree->node,
+                              area->x + (area->width - width) / 2,
+                              area->y + (area->height - height) / 2);
+
+  static const float background[4] = SWITCHER_BACKGROUND_COLOR;
+  static const float selection[4] = BORDER_COLOR_FOCUSED;
+  wlr_scene_rect_create(overlay->tree, width, height, background);
+  overlay->selection = wlr_scene_rect_create(overlay->tree, cell, cell,
+                                             selection);
+  wlr_scene_node_set_enabled(&overlay->selection->node, false);
+
+  wl_list_for_each(toplevel, &server->toplevels, link) {
+    if (overlay->entry_count == count) {
+      break;
+    }
+    if (!is_selectable(toplevel)) {
+      continue;
+    }
+    size_t i = overlay->entry_count++;
+    struct tinywl_switcher_entry *entry = &overlay->entries[i];
+    entry->toplevel = toplevel;
+    entry->x = SWITCHER_PADDING + (int)(i % columns) * cell;
+    entry->y = SWITCHER_PADDING + (int)(i / columns) * cell;
+
+    struct wlr_buffer *buffer =
+        thumbnail_get(toplevel, THUMBNAIL_SIZE, THUMBNAIL_SIZE);
+    if (buffer == NULL) {
+      continue;
+    }
+    struct wlr_scene_buffer *scene_buffer =
+        wlr_scene_buffer_create(overlay->tree, buffer);
+    wlr_scene_node_set_position(
+        &scene_buffer->node,
+        entry->x + SWITCHER_PADDING + (THUMBNAIL_SIZE - buffer->width) / 2,
+        entry->y + SWITCHER_PADDING + (THUMBNAIL_SIZE - buffer->height) / 2);
+  }
+  server->switcher_overlay = overlay;
+}
+
+static void overlay_destroy(struct tinywl_server *server) {
+  struct tinywl_switcher_overlay *overlay = server->switcher_overlay;
+  if (overlay == NULL) {
+    return;
+  }
+  wlr_scene_node_destroy(&overlay->tree->node);
+  free(overlay->entries);
+  free(overlay);
+  server->switcher_overlay = NULL;
+}
+
+static void overlay_select(struct tinywl_server *server,
+                           struct tinywl_toplevel *toplevel) {
+  struct tinywl_switcher_overlay *overlay = server->switcher_overlay;
+  if (overlay == NULL) {
+    return;
+  }
+  for (size_t i = 0; i < overlay->entry_count; i++) {
+    struct tinywl_switcher_entry *entry = &overlay->entries[i];
+    if (entry->toplevel == toplevel) {
+      wlr_scene_node_set_position(&overlay->selection->node, entry->x,
+                                  entry->y);
+      wlr_scene_node_set_enabled(&overlay->selection->node, true);
+      return;
+    }
+  }
+  wlr_scene_node_set_enabled(&overlay->selection->node, false);
+}
+
+static void select_toplevel(struct tinywl_server *server,
+                            struct tinywl_toplevel *toplevel) {
+  /* A new switch takes the highlight away from the focused window */
+  struct tinywl_toplevel *selected = server->switcher_selected != NULL
+                                         ? server->switcher_selected
+                                         : get_focused_toplevel(server);
+  if (selected != NULL) {
+    toplevel_set_border_focused(selected, false);
+  }
+  server->switcher_selected = toplevel;
+  toplevel_set_border_focused(toplevel, true);
+  overlay_select(server, toplevel);
+}
+
+static void step(struct tinywl_server *server, bool forward) {
+  if (wl_list_empty(&server->toplevels)) {
+    return;
+  }
+  /* A new switch starts at the focused window, which is the list's head */
+  struct wl_list *start = server->switcher_selected != NULL
+                              ? &server->switcher_selected->link
+                              : server->toplevels.next;
+  struct wl_list *link = start;
+  do {
+    link = forward ? link->next : link->prev;
+    if (link == &server->toplevels) {
+      continue;
+    }
+    struct tinywl_toplevel *toplevel = wl_container_of(link, toplevel, link);
+    if (is_selectable(toplevel)) {
+      if (server->switcher_selected == NULL) {
+        overlay_create(server);
+      }
+      select_toplevel(server, toplevel);
+      return;
+    }
+  } while (link != start);
+}
+
+void switcher_next(struct tinywl_server *server) { step(server, true); }
+
+void switcher_prev(struct tinywl_server *server) { step(server, false); }
+
+void switcher_commit(struct tinywl_server *server) {
+  struct tinywl_toplevel *selected = server->switcher_selected;
+  if (selected == NULL) {
+    return;
+  }
+  server->switcher_selected = NULL;
+  overlay_destroy(server);
+
+  /* Sets the border colors of both windows again */
+  focus_toplevel(selected);
+}
+
+void switcher_toplevel_unmap(struct tinywl_toplevel *toplevel) {
+  struct tinywl_server *server = toplevel->server;
+  struct tinywl_switcher_overlay *overlay = server->switcher_overlay;
+  if (overlay != NULL) {
+    /* Its thumbnail stays up until the switch ends */
+    for (size_t i = 0; i < overlay->entry_count; i++) {
+      if (overlay->entries[i].toplevel == toplevel) {
+        overlay->entries[i].toplevel = NULL;
+      }
+    }
+  }
+  if (server->switcher_selected != toplevel) {
+    return;
+  }
+  server->switcher_selected = NULL;
+  overlay_destroy(server);
+  toplevel_set_border_focused(toplevel, false);
+  struct tinywl_toplevel *focused = get_focused_toplevel(server);
+  if (focused != NULL) {
+    toplevel_set_border_focused(focused, true);
+  }
+}
@@ -0,0 +1,207 @@
+#include <drm_fourcc.h>
+#include <stdlib.h>
+#include <wlr/render/allocator.h>
+#include <wlr/render/drm_format_set.h>
+#include <wlr/render/pass.h>
+#include <wlr/render/wlr_renderer.h>
+#include <wlr/render/wlr_texture.h>
+#include <wlr/types/wlr_buffer.h>
+
+#include "config.h"
+#include "thumbnail.h"
+#include "toplevel.h"
+
+struct render_data {
+  struct wlr_renderer *renderer;
+  struct wlr_render_pass *pass;
+  double scale;
+  struct wl_array textures; /* Textures to destroy after the pass */
+};
+
+static void render_iterator(struct wlr_scene_buffer *scene_buffer, int sx,
+                            int sy, void *user_data) {
+  struct render_data *render = user_data;
+  struct wlr_buffer *buffer = scene_buffer->buffer;
+  if (buffer == NULL) {
+    return;
+  }
+
+  /* Client buffers already have a texture, anything else is imported */
+  struct wlr_texture *texture = NULL;
+  struct wlr_client_buffer *client_buffer = wlr_client_buffer_get(buffer);
+  if (client_buffer != NULL) {
+    texture = client_buffer->texture;
+  }
+  if (texture == NULL) {
+    texture = wlr_texture_from_buffer(render->renderer, buffer);
+    if (texture == NULL) {
+      return;
+    }
+    struct wlr_texture **entry = wl_array_add(&render->textures, sizeof(texture));
+    *entry = texture;
+  }
+
+  int width = scene_buffer->dst_width > 0 ? scene_buffer->dst_width
+                                          : buffer->width;
+  int height = scene_buffer->dst_height > 0 ? scene_buffer->dst_height
+                                            : buffer->height;
+  int x1 = (int)(sx * render->scale);
+  int y1 = (int)(sy * render->scale);
+  int x2 = (int)((sx + width) * render->scale);
+  int y2 = (int)((sy + height) * render->scale);
+  if (x2 <= x1 || y2 <= y1) {
+    return;
+  }
+  wlr_render_pass_add_texture(
+      render->pass, &(struct wlr_render_texture_options){
+                        .texture = texture,
+                        .src_box = scene_buffer->src_box,
+                        .dst_box = {x1, y1, x2 - x1, y2 - y1},
+                        .alpha = &scene_buffer->opacity,
+                        .transform = scene_buffer->transform,
+                        .filter_mode = WLR_SCALE_FILTER_BILINEAR,
+                    });
+}
+
+static double fit_scale(const struct wlr_box *geo_box, int max_width,
+                        int max_height, int *width, int *height) {
+  /* Keep the aspect ratio, never scaling up */
+  double scale_x = (double)max_width / geo_box->width;
+  double scale_y = (double)max_height / geo_box->height;
+  double scale = scale_x < scale_y ? scale_x : scale_y;
+  if (scale > 1.0) {
+    scale = 1.0;
+  }
+  *width = (int)(geo_box->width * scale);
+  *height = (int)(geo_box->height * scale);
+  *width = *width > 0 ? *width : 1;
+  *height = *height > 0 ? *height : 1;
+  return scale;
+}
+
+static struct wlr_buffer *render_thumbnail(struct tinywl_toplevel *toplevel,
+                                           int max_width, int max_height) {
+  struct tinywl_server *server = toplevel->server;
+  struct wlr_box *geo_box = &toplevel->xdg_toplevel->base->geometry;
+  int width, height;
+  double scale = fit_scale(geo_box, max_width, max_height, &width, &height);
+
+  /* An implicit modifier works with every allocator */
+  struct wlr_drm_format_set formats = {0};
+  wlr_drm_format_set_add(&formats, DRM_FORMAT_ARGB8888, DRM_FORMAT_MOD_INVALID);
+  struct wlr_buffer *buffer = wlr_allocator_create_buffer(
+      server->allocator, width, height,
+      wlr_drm_format_set_get(&formats, DRM_FORMAT_ARGB8888));
+  wlr_drm_format_set_finish(&formats);
+  if (buffer == NULL) {
+    wlr_log(WLR_ERROR, "failed to allocate a %dx%d thumbnail", width, height);
+    return NULL;
+  }
+
+  struct wlr_render_pass *pass =
+      wlr_renderer_begin_buffer_pass(server->renderer, buffer, NULL);
+  if (pass == NULL) {
+    wlr_buffer_drop(buffer);
+    return NULL;
+  }
+  wlr_render_pass_add_rect(pass, &(struct wlr_render_rect_options){
+                                     .box = {0, 0, width, height},
+                                     .color = {0, 0, 0, 0},
+                                     .blend_mode = WLR_RENDER_BLEND_MODE_NONE,
+                                 });
+
+  /* The window's own node is disabled in hidden tabs and while minimized,
+   * and the iterator skips disabled nodes, so its children are walked
+   * instead. Their buffer positions are relative to the window's geometry
+   * origin. */
+  struct render_data render = {
+      .renderer = server->renderer,
+      .pass = pass,
+      .scale = scale,
+  };
+  wl_array_init(&render.textures);
+  struct wlr_scene_node *child;
+  wl_list_for_each(child, &toplevel->scene_tree->children, link) {
+    wlr_scene_node_for_each_buffer(child, render_iterator, &render);
+  }
+  bool ok = wlr_render_pass_submit(pass);
+
+  struct wlr_texture **texture;
+  wl_array_for_each(texture, &render.textures) {
+    wlr_texture_destroy(*texture);
+  }
+  wl_array_release(&render.textures);
+
+  if (!ok) {
+    wlr_buffer_drop(buffer);
+    return NULL;
+  }
+  return buffer;
+}
+
+static void thumbnail_destroy(struct tinywl_thumbnail *thumbnail) {
+  struct tinywl_server *server = thumbnail->toplevel->server;
+  server->thumbnail_bytes -= thumbnail->size;
+  thumbnail->toplevel->thumbnail = NULL;
+  wl_list_remove(&thumbnail->link);
+  wlr_buffer_drop(thumbnail->buffer);
+  free(thumbnail);
+}
+
+struct wlr_buffer *thumbnail_get(struct tinywl_toplevel *toplevel,
+                                 int max_width, int max_height) {
+  struct tinywl_server *server = toplevel->server;
+  struct wlr_box *geo_box = &toplevel->xdg_toplevel->base->geometry;
+  if (wlr_box_empty(geo_box) || max_width <= 0 || max_height <= 0) {
+    return NULL;
+  }
+  int width, height;
+  fit_scale(geo_box, max_width, max_height, &width, &height);
+
+  struct tinywl_thumbnail *thumbnail = toplevel->thumbnail;
+  if (thumbnail != NULL && thumbnail->commit_seq == toplevel->commit_seq &&
+      thumbnail->buffer->width == width &&
+      thumbnail->buffer->height == height) {
+    wl_list_remove(&thumbnail->link);
+    wl_list_insert(&server->thumbnails, &thumbnail->link);
+    return thumbnail->buffer;
+  }
+  if (thumbnail != NULL) {
+    thumbnail_destroy(thumbnail);
+  }
+
+  struct wlr_buffer *buffer = render_thumbnail(toplevel, max_width, max_height);
+  if (buffer == NULL) {
+    return NULL;
+  }
+  thumbnail = calloc(1, sizeof(*thumbnail));
+  thumbnail->toplevel = toplevel;
+  thumbnail->buffer = buffer;
+  thumbnail->commit_seq = toplevel->commit_seq;
+  thumbnail->size = (size_t)buffer->width * buffer->height * 4;
+  toplevel->thumbnail = thumbnail;
+  wl_list_insert(&server->thumbnails, &thumbnail->link);
+  server->thumbnail_bytes += thumbnail->size;
+
+  /* Evict from the least recently used end, keeping the new one */
+  while (server->thumbnail_bytes > THUMBNAIL_CACHE_SIZE &&
+         server->thumbnails.prev != &thumbnail->link) {
+    struct tinywl_thumbnail *oldest =
+        wl_container_of(server->thumbnails.prev, oldest, link);
+    thumbnail_destroy(oldest);
+  }
+  return buffer;
+}
+
+void thumbnail_discard(struct tinywl_toplevel *toplevel) {
+  if (toplevel->thumbnail != NULL) {
+    thumbnail_destroy(toplevel->thumbnail);
+  }
+}
+
+void thumbnail_finish(struct tinywl_server *server) {
+  struct tinywl_thumbnail *thumbnail, *tmp;
+  wl_list_for_each_safe(thumbnail, tmp, &server->thumbnails, link) {
+    thumbnail_destroy(thumbnail);
+  }
+}
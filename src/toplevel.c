@@ -1,17 +1,136 @@
 #include "toplevel.h"
+#include "animation.h"
+#include "config.h"
+#include "cursor.h"
+#include "decoration.h"
 #include "utils.h"
 #include "input.h"
+#include "layout.h"
+#include "occlusion.h"
+#include "output.h"
+#include "overview.h"
+#include "rules.h"
+#include "scratchpad.h"
+#include "session.h"
+#include "snapshot.h"
+#include "spatial.h"
+#include "switcher.h"
+#include "thumbnail.h"
+#include "transaction.h"
+#include "workspace.h"
 #include <stdlib.h>
 
+static bool toplevel_wants_floating(struct tinywl_toplevel *toplevel) {
+  /* Dialogs and fixed-size windows don't make sense as tiles */
+  struct wlr_xdg_toplevel *xdg_toplevel = toplevel->xdg_toplevel;
+  if (xdg_toplevel->parent != NULL) {
+    return true;
+  }
+  struct wlr_xdg_toplevel_state *state = &xdg_toplevel->current;
+  return state->min_width > 0 && state->min_height > 0 &&
+         state->min_width == state->max_width &&
+         state->min_height == state->max_height;
+}
+
+static struct tinywl_workspace *
+place_toplevel(struct tinywl_toplevel *toplevel,
+               const struct tinywl_rule_result *rule) {
+  struct tinywl_server *server = toplevel->server;
+  bool floating = rule->floating != RULE_UNSET
+                      ? rule->floating == RULE_YES
+                      : toplevel_wants_floating(toplevel);
+
+  struct tinywl_output *output =
+      output_at(server, server->cursor->x, server->cursor->y);
+  if (output == NULL) {
+    return NULL;
+  }
+  struct tinywl_workspace *workspace = output->active_workspace;
+  if (rule->workspace > 0 && rule->workspace <= WORKSPACE_COUNT) {
+    workspace = &output->workspaces[rule->workspace - 1];
+  }
+
+  if (!floating) {
+    wlr_xdg_toplevel_set_tiled(toplevel->xdg_toplevel,
+                               WLR_EDGE_TOP | WLR_EDGE_BOTTOM | WLR_EDGE_LEFT |
+                                   WLR_EDGE_RIGHT);
+    /* Keep the window hidden until the transaction puts it in its tile */
+    wlr_scene_node_set_enabled(&toplevel->scene_tree->node, false);
+    toplevel->awaiting_placement = true;
+    workspace_add_toplevel(workspace, toplevel, true);
+    return workspace;
+  }
+
+  /* Floating windows start centered on the output under the cursor */
+  struct wlr_box output_box;
+  wlr_output_layout_get_box(server->output_layout, output->wlr_output,
+                            &output_box);
+  struct wlr_box *geo_box = &toplevel->xdg_toplevel->base->geometry;
+  int width = rule->width > 0 ? rule->width : geo_box->width;
+  int height = rule->height > 0 ? rule->height : geo_box->height;
+  struct wlr_box box = {
+      .x = output_box.x + (output_box.width - width) / 2,
+      .y = output_box.y + (output_box.height - height) / 2,
+      .width = width,
+      .height = height,
+  };
+  wlr_scene_node_set_position(&toplevel->scene_tree->node, box.x, box.y);
+  workspace_add_toplevel(workspace, toplevel, false);
+  if (toplevel->xdg_toplevel->requested.maximized) {
+    toplevel_set_maximized(toplevel, true);
+    transaction_commit(server);
+  } else if (rule->width > 0) {
+    /* Hidden until the client drew at the size the rule asks for */
+    wlr_scene_node_set_enabled(&toplevel->scene_tree->node, false);
+    toplevel->awaiting_placement = true;
+    toplevel->tile = box;
+    transaction_add_toplevel(toplevel, wlr_xdg_toplevel_set_size(
+                                           toplevel->xdg_toplevel,
+                                           width, height));
+    transaction_commit(server);
+  }
+  return workspace;
+}
 
 static void xdg_toplevel_map(struct wl_listener *listener, void *data) {
   (void)data; // data is unused here
   /* Called when the surface is mapped, or ready to display on-screen. */
   struct tinywl_toplevel *toplevel = wl_container_of(listener, toplevel, map);
 
-  wl_list_insert(&toplevel->server->toplevels, &toplevel->link);
+  struct tinywl_server *server = toplevel->server;
+  wl_list_insert(&server->toplevels, &toplevel->link);
+  /* Hidden since it was unmapped, placing it may hide it again */
+  wlr_scene_node_set_enabled(&toplevel->scene_tree->node, true);
 
-  focus_toplevel(toplevel);
+  struct tinywl_rule_result rule;
+  rules_match(server, toplevel->xdg_toplevel->app_id,
+              toplevel->xdg_toplevel->title, &rule);
+  /* Windows decorating themselves don't get borders on top, unless asked */
+  toplevel->borders_hidden =
+      rule.border == RULE_NO ||
+      (rule.border == RULE_UNSET && rule.client_decorations == RULE_YES);
+  toplevel->unthrottled = rule.throttle == RULE_NO;
+
+  /* A window of the restored session goes back to its place, the rules only
+   * pick a place for new ones */
+  struct tinywl_workspace *workspace = session_place(toplevel);
+  if (workspace == NULL) {
+    workspace = place_toplevel(toplevel, &rule);
+  }
+  if (workspace == NULL) {
+    focus_toplevel(toplevel);
+    return;
+  }
+
+  bool shown = workspace == workspace->output->active_workspace;
+  if (!toplevel->awaiting_placement && shown) {
+    animation_fade_in(server, &toplevel->content_tree->node);
+  }
+
+  /* Windows sent to another workspace don't take focus */
+  if (shown) {
+    focus_toplevel(toplevel);
+  }
 }
 
 static void xdg_toplevel_unmap(struct wl_listener *listener, void *data) {
@@ -23,8 +142,34 @@ static void xdg_toplevel_unmap(struct wl_listener *listener, void *data) {
   if (toplevel == toplevel->server->grabbed_toplevel) {
     reset_cursor_mode(toplevel->server);
   }
+  if (toplevel == toplevel->server->focus_candidate) {
+    toplevel->server->focus_candidate = NULL;
+    toplevel->server->focus_pending = false;
+  }
+  switcher_toplevel_unmap(toplevel);
+  overview_toplevel_unmap(toplevel);
+  thumbnail_discard(toplevel);
+  animation_finish_node(toplevel->server, &toplevel->scene_tree->node);
+  animation_finish_node(toplevel->server, &toplevel->content_tree->node);
+  animation_fade_out(toplevel);
 
   wl_list_remove(&toplevel->link);
+
+  transaction_remove_toplevel(toplevel);
+  workspace_remove_toplevel(toplevel);
+  output_forget_toplevel(toplevel);
+  toplevel->tile = (struct wlr_box){0};
+  toplevel->maximized = false;
+  toplevel->resize_serial = 0;
+  toplevel->resize_queued = false;
+  snapshot_destroy(toplevel->resize_snapshot);
+  toplevel->resize_snapshot = NULL;
+  wlr_scene_node_set_enabled(&toplevel->content_tree->node, true);
+  /* The tree was moved to the scene root, its borders mustn't show there */
+  wlr_scene_node_set_enabled(&toplevel->scene_tree->node, false);
+  toplevel->awaiting_placement = false;
+  toplevel->hidden = false;
+  toplevel->scratchpad = false;
 }
 
 static void xdg_toplevel_commit(struct wl_listener *listener, void *data) {
@@ -32,19 +177,72 @@ static void xdg_toplevel_commit(struct wl_listener *listener, void *data) {
   /* Called when a new surface state is committed. */
   struct tinywl_toplevel *toplevel =
       wl_container_of(listener, toplevel, commit);
+  toplevel->commit_seq++;
+  overview_toplevel_commit(toplevel);
 
   if (toplevel->xdg_toplevel->base->initial_commit) {
     /* When an xdg_surface performs an initial commit, the compositor must
-     * reply with a configure so the client can map the surface. tinywl
-     * configures the xdg_toplevel with 0,0 size to let the client pick the
-     * dimensions itself. */
-    wlr_xdg_toplevel_set_size(toplevel->xdg_toplevel, 0, 0);
+     * reply with a configure so the client can map the surface. A window
+     * that had a place in the restored session is sent that place's size,
+     * others are configured with 0,0 to pick the dimensions themselves. */
+    if (!session_claim(toplevel)) {
+      wlr_xdg_toplevel_set_size(toplevel->xdg_toplevel, 0, 0);
+    }
+    /* Goes out with the same configure */
+    decoration_update(toplevel);
+  }
+
+  /* Keep the geometry origin at the scene tree's origin, clients with
+   * client-side shadows have a non-zero geometry offset. */
+  struct wlr_box *geo_box = &toplevel->xdg_toplevel->base->geometry;
+  wlr_scene_node_set_position(&toplevel->content_tree->node, -geo_box->x,
+                              -geo_box->y);
+
+  transaction_notify_commit(toplevel);
+  cursor_resize_notify_commit(toplevel);
+
+  /* Floating windows pick their own size, which can uncover others */
+  if (toplevel->container == NULL && toplevel->workspace != NULL) {
+    occlusion_schedule(toplevel->server);
+  }
+
+  /* Borders of windows in a transaction are updated when it is applied, so
+   * they move together with the window. Maximized windows have none. */
+  if (!toplevel->in_transaction && !toplevel->maximized) {
+    toplevel_update_borders(toplevel);
+  }
+
+  /* The window's size or its subsurfaces may have changed */
+  spatial_update_toplevel(toplevel);
+}
+
+void toplevel_update_borders(struct tinywl_toplevel *toplevel) {
+  bool enabled = !toplevel->maximized && !toplevel->borders_hidden;
+  if (enabled != toplevel->borders_enabled) {
+    wlr_scene_node_set_enabled(&toplevel->border_top->node, enabled);
+    wlr_scene_node_set_enabled(&toplevel->border_bottom->node, enabled);
+    wlr_scene_node_set_enabled(&toplevel->border_left->node, enabled);
+    wlr_scene_node_set_enabled(&toplevel->border_right->node, enabled);
+    toplevel->borders_enabled = enabled;
+  }
+  if (!enabled) {
+    return;
   }
 
   // Update border dimensions based on surface size
   struct wlr_box *geo_box = &toplevel->xdg_toplevel->base->geometry;
-  int border_width = 2;
+  if (toplevel->resize_snapshot != NULL) {
+    geo_box = &toplevel->resize_queued_box;
+  }
+  if (geo_box->width == toplevel->border_geo_width &&
+      geo_box->height == toplevel->border_geo_height) {
+    return;
+  }
+  toplevel->border_geo_width = geo_box->width;
+  toplevel->border_geo_height = geo_box->height;
 
+  /* The top and left borders never move, see server_new_xdg_toplevel() */
+  int border_width = BORDER_WIDTH;
   wlr_scene_rect_set_size(toplevel->border_top, geo_box->width, border_width);
   wlr_scene_rect_set_size(toplevel->border_bottom, geo_box->width,
                           border_width);
@@ -52,14 +250,101 @@ static void xdg_toplevel_commit(struct wl_listener *listener, void *data) {
   wlr_scene_rect_set_size(toplevel->border_right, border_width,
                           geo_box->height);
 
-  wlr_scene_node_set_position(&toplevel->border_top->node, geo_box->x,
-                              geo_box->y - border_width);
-  wlr_scene_node_set_position(&toplevel->border_bottom->node, geo_box->x,
-                              geo_box->y + geo_box->height);
-  wlr_scene_node_set_position(&toplevel->border_left->node,
-                              geo_box->x - border_width, geo_box->y);
-  wlr_scene_node_set_position(&toplevel->border_right->node,
-                              geo_box->x + geo_box->width, geo_box->y);
+  wlr_scene_node_set_position(&toplevel->border_bottom->node, 0,
+                              geo_box->height);
+  wlr_scene_node_set_position(&toplevel->border_right->node, geo_box->width,
+                              0);
+}
+
+void toplevel_set_border_focused(struct tinywl_toplevel *toplevel,
+                                 bool focused) {
+  if (focused == toplevel->border_focused) {
+    return;
+  }
+  static const float focused_color[4] = BORDER_COLOR_FOCUSED;
+  static const float unfocused_color[4] = BORDER_COLOR_UNFOCUSED;
+  animation_border_color(toplevel, focused ? focused_color : unfocused_color);
+  toplevel->border_focused = focused;
+}
+
+void toplevel_set_activated(struct tinywl_toplevel *toplevel, bool activated) {
+  wlr_xdg_toplevel_set_activated(toplevel->xdg_toplevel, activated);
+  toplevel_set_border_focused(toplevel, activated);
+}
+
+static void frame_done_iterator(struct wlr_surface *surface, int sx, int sy,
+                                void *data) {
+  (void)sx; // surface coordinates are unused here
+  (void)sy;
+  wlr_surface_send_frame_done(surface, data);
+}
+
+void toplevel_send_frame_done(struct tinywl_toplevel *toplevel,
+                              const struct timespec *when) {
+  wlr_xdg_surface_for_each_surface(toplevel->xdg_toplevel->base,
+                                   frame_done_iterator, (void *)when);
+}
+
+/* Follows the commits of one of a window's subsurfaces */
+struct subsurface_watch {
+  struct tinywl_toplevel *toplevel;
+  struct wl_list link;
+  struct wl_listener commit;
+  struct wl_listener new_subsurface;
+  struct wl_listener destroy;
+};
+
+static void subsurface_watch_create(struct tinywl_toplevel *toplevel,
+                                    struct wlr_subsurface *subsurface);
+
+static void subsurface_commit(struct wl_listener *listener, void *data) {
+  (void)data; // data is unused here
+  /* Desynchronized subsurfaces, like video, commit without their parent */
+  struct subsurface_watch *watch = wl_container_of(listener, watch, commit);
+  watch->toplevel->commit_seq++;
+  overview_toplevel_commit(watch->toplevel);
+}
+
+static void subsurface_new_subsurface(struct wl_listener *listener,
+                                      void *data) {
+  struct subsurface_watch *watch =
+      wl_container_of(listener, watch, new_subsurface);
+  subsurface_watch_create(watch->toplevel, data);
+}
+
+static void subsurface_watch_destroy(struct subsurface_watch *watch) {
+  wl_list_remove(&watch->link);
+  wl_list_remove(&watch->commit.link);
+  wl_list_remove(&watch->new_subsurface.link);
+  wl_list_remove(&watch->destroy.link);
+  free(watch);
+}
+
+static void subsurface_destroy(struct wl_listener *listener, void *data) {
+  (void)data; // data is unused here
+  struct subsurface_watch *watch = wl_container_of(listener, watch, destroy);
+  subsurface_watch_destroy(watch);
+}
+
+static void subsurface_watch_create(struct tinywl_toplevel *toplevel,
+                                    struct wlr_subsurface *subsurface) {
+  struct subsurface_watch *watch = calloc(1, sizeof(*watch));
+  watch->toplevel = toplevel;
+  wl_list_insert(&toplevel->subsurfaces, &watch->link);
+  watch->commit.notify = subsurface_commit;
+  wl_signal_add(&subsurface->surface->events.commit, &watch->commit);
+  watch->new_subsurface.notify = subsurface_new_subsurface;
+  wl_signal_add(&subsurface->surface->events.new_subsurface,
+                &watch->new_subsurface);
+  watch->destroy.notify = subsurface_destroy;
+  wl_signal_add(&subsurface->events.destroy, &watch->destroy);
+}
+
+static void xdg_toplevel_new_subsurface(struct wl_listener *listener,
+                                        void *data) {
+  struct tinywl_toplevel *toplevel =
+      wl_container_of(listener, toplevel, new_subsurface);
+  subsurface_watch_create(toplevel, data);
 }
 
 static void xdg_toplevel_destroy(struct wl_listener *listener, void *data) {
@@ -76,6 +361,17 @@ static void xdg_toplevel_destroy(struct wl_listener *listener, void *data) {
   wl_list_remove(&toplevel->request_resize.link);
   wl_list_remove(&toplevel->request_maximize.link);
   wl_list_remove(&toplevel->request_fullscreen.link);
+  wl_list_remove(&toplevel->request_minimize.link);
+  wl_list_remove(&toplevel->new_subsurface.link);
+  /* The surface and its subsurfaces can outlive the window */
+  struct subsurface_watch *watch, *tmp;
+  wl_list_for_each_safe(watch, tmp, &toplevel->subsurfaces, link) {
+    subsurface_watch_destroy(watch);
+  }
+  decoration_finish(toplevel);
+  session_release(toplevel);
+  /* Takes the borders and the xdg surface's tree with it */
+  wlr_scene_node_destroy(&toplevel->scene_tree->node);
 
   free(toplevel);
 }
@@ -110,18 +406,21 @@ static void xdg_toplevel_request_resize(struct wl_listener *listener,
 static void xdg_toplevel_request_maximize(struct wl_listener *listener,
                                           void *data) {
   (void)data; // data is unused here
-  /* This event is raised when a client would like to maximize itself,
-   * typically because the user clicked on the maximize button on client-side
-   * decorations. tinywl doesn't support maximization, but to conform to
-   * xdg-shell protocol we still must send a configure.
-   * wlr_xdg_surface_schedule_configure() is used to send an empty reply.
-   * However, if the request was sent before an initial commit, we don't do
-   * anything and let the client finish the initial surface setup. */
+  /* This event is raised when a client would like to maximize or unmaximize
+   * itself, typically because the user clicked on the maximize button on
+   * client-side decorations. The xdg-shell protocol wants a configure in
+   * reply even when we don't honor the request, scheduling one is a no-op if
+   * maximizing already did. If the request was sent before an initial commit,
+   * we don't do anything and let the client finish the initial surface setup,
+   * the request is picked up when the window is mapped. */
   struct tinywl_toplevel *toplevel =
       wl_container_of(listener, toplevel, request_maximize);
-  if (toplevel->xdg_toplevel->base->initialized) {
-    wlr_xdg_surface_schedule_configure(toplevel->xdg_toplevel->base);
+  if (!toplevel->xdg_toplevel->base->initialized) {
+    return;
   }
+  toplevel_set_maximized(toplevel, toplevel->xdg_toplevel->requested.maximized);
+  transaction_commit(toplevel->server);
+  wlr_xdg_surface_schedule_configure(toplevel->xdg_toplevel->base);
 }
 
 static void xdg_toplevel_request_fullscreen(struct wl_listener *listener,
@@ -134,7 +433,98 @@ static void xdg_toplevel_request_fullscreen(struct wl_listener *listener,
     wlr_xdg_surface_schedule_configure(toplevel->xdg_toplevel->base);
   }
 }
+static void xdg_toplevel_request_minimize(struct wl_listener *listener,
+                                          void *data) {
+  (void)data; // data is unused here
+  /* Minimized windows stay mapped, see scratchpad.h. There is no minimized
+   * state to send back, the window is told that it is suspended instead. */
+  struct tinywl_toplevel *toplevel =
+      wl_container_of(listener, toplevel, request_minimize);
+  toplevel_hide(toplevel);
+}
+
+void toplevel_set_maximized(struct tinywl_toplevel *toplevel, bool maximized) {
+  if (toplevel->workspace == NULL || toplevel->container != NULL) {
+    return;
+  }
+
+  struct wlr_box target;
+  if (maximized) {
+    if (!toplevel->maximized) {
+      struct wlr_box *geo_box = &toplevel->xdg_toplevel->base->geometry;
+      toplevel->floating_box = (struct wlr_box){
+          .x = toplevel->scene_tree->node.x,
+          .y = toplevel->scene_tree->node.y,
+          .width = geo_box->width,
+          .height = geo_box->height,
+      };
+    }
+    target = toplevel->workspace->output->usable_area;
+  } else if (toplevel->maximized) {
+    target = toplevel->floating_box;
+  } else {
+    return;
+  }
+
+  if (toplevel->maximized == maximized &&
+      wlr_box_equal(&target, &toplevel->tile)) {
+    return;
+  }
+  toplevel->maximized = maximized;
+  wlr_xdg_toplevel_set_maximized(toplevel->xdg_toplevel, maximized);
+  uint32_t serial = wlr_xdg_toplevel_set_size(toplevel->xdg_toplevel,
+                                              target.width, target.height);
+  toplevel->tile = target;
+  transaction_add_toplevel(toplevel, serial);
+}
+
+static void tile_inner_box(const struct wlr_box *box, struct wlr_box *inner) {
+  *inner = (struct wlr_box){
+      .x = box->x + BORDER_WIDTH,
+      .y = box->y + BORDER_WIDTH,
+      .width = box->width - 2 * BORDER_WIDTH,
+      .height = box->height - 2 * BORDER_WIDTH,
+  };
+  if (inner->width < 1) {
+    inner->width = 1;
+  }
+  if (inner->height < 1) {
+    inner->height = 1;
+  }
+}
 
+void toplevel_preset_tile(struct tinywl_toplevel *toplevel,
+                          const struct wlr_box *box) {
+  struct wlr_box inner;
+  tile_inner_box(box, &inner);
+  wlr_xdg_toplevel_set_tiled(toplevel->xdg_toplevel,
+                             WLR_EDGE_TOP | WLR_EDGE_BOTTOM | WLR_EDGE_LEFT |
+                                 WLR_EDGE_RIGHT);
+  wlr_xdg_toplevel_set_size(toplevel->xdg_toplevel, inner.width,
+                            inner.height);
+  /* Only the size is known to the client, the position still has to be
+   * applied by the first transaction */
+  toplevel->tile = (struct wlr_box){0, 0, inner.width, inner.height};
+}
+
+void toplevel_set_tile(struct tinywl_toplevel *toplevel,
+                       const struct wlr_box *box) {
+  struct wlr_box inner;
+  tile_inner_box(box, &inner);
+
+  if (wlr_box_equal(&inner, &toplevel->tile)) {
+    return;
+  }
+
+  uint32_t serial = 0;
+  if (inner.width != toplevel->tile.width ||
+      inner.height != toplevel->tile.height) {
+    serial = wlr_xdg_toplevel_set_size(toplevel->xdg_toplevel, inner.width,
+                                       inner.height);
+  }
+  toplevel->tile = inner;
+  transaction_add_toplevel(toplevel, serial);
+}
 
 void server_new_xdg_toplevel(struct wl_listener *listener, void *data) {
   /* This event is raised when a client creates a new toplevel (application
@@ -147,14 +537,15 @@ void server_new_xdg_toplevel(struct wl_listener *listener, void *data) {
   struct tinywl_toplevel *toplevel = calloc(1, sizeof(*toplevel));
   toplevel->server = server;
   toplevel->xdg_toplevel = xdg_toplevel;
-  toplevel->scene_tree = wlr_scene_xdg_surface_create(
-      &toplevel->server->scene->tree, xdg_toplevel->base);
+  toplevel->scene_tree = wlr_scene_tree_create(&toplevel->server->scene->tree);
   toplevel->scene_tree->node.data = toplevel;
-  xdg_toplevel->base->data = toplevel->scene_tree;
+  toplevel->content_tree =
+      wlr_scene_xdg_surface_create(toplevel->scene_tree, xdg_toplevel->base);
+  xdg_toplevel->base->data = toplevel->content_tree;
 
   // Create borders
-  int border_width = 2;
-  float border_color[4] = {1.0f, 0.647f, 0.0f, 1.0f};
+  int border_width = BORDER_WIDTH;
+  float border_color[4] = BORDER_COLOR_UNFOCUSED;
 
   /* This is currently borked for lutris */
   toplevel->border_top = wlr_scene_rect_create(toplevel->scene_tree, 0,
@@ -166,6 +557,8 @@ void server_new_xdg_toplevel(struct wl_listener *listener, void *data) {
   toplevel->border_right = wlr_scene_rect_create(toplevel->scene_tree,
                                                  border_width, 0, border_color);
 
+  toplevel->borders_enabled = true;
+
   // Position borders (they'll be updated on commit)
   wlr_scene_node_set_position(&toplevel->border_top->node, 0, -border_width);
   wlr_scene_node_set_position(&toplevel->border_left->node, -border_width, 0);
@@ -177,6 +570,10 @@ void server_new_xdg_toplevel(struct wl_listener *listener, void *data) {
   wl_signal_add(&xdg_toplevel->base->surface->events.unmap, &toplevel->unmap);
   toplevel->commit.notify = xdg_toplevel_commit;
   wl_signal_add(&xdg_toplevel->base->surface->events.commit, &toplevel->commit);
+  wl_list_init(&toplevel->subsurfaces);
+  toplevel->new_subsurface.notify = xdg_toplevel_new_subsurface;
+  wl_signal_add(&xdg_toplevel->base->surface->events.new_subsurface,
+                &toplevel->new_subsurface);
 
   toplevel->destroy.notify = xdg_toplevel_destroy;
   wl_signal_add(&xdg_toplevel->events.destroy, &toplevel->destroy);
@@ -193,4 +590,7 @@ void server_new_xdg_toplevel(struct wl_listener *listener, void *data) {
   toplevel->request_fullscreen.notify = xdg_toplevel_request_fullscreen;
   wl_signal_add(&xdg_toplevel->events.request_fullscreen,
                 &toplevel->request_fullscreen);
+  toplevel->request_minimize.notify = xdg_toplevel_request_minimize;
+  wl_signal_add(&xdg_toplevel->events.request_minimize,
+                &toplevel->request_minimize);
 }
@@ -0,0 +1,146 @@
+#include <stdlib.h>
+
+#include "animation.h"
+#include "occlusion.h"
+#include "spatial.h"
+#include "toplevel.h"
+#include "transaction.h"
+
+static void transaction_apply(struct tinywl_server *server) {
+  struct tinywl_transaction *txn = server->transaction;
+
+  struct tinywl_toplevel *toplevel, *tmp;
+  wl_list_for_each_safe(toplevel, tmp, &txn->toplevels, txn_link) {
+    if (toplevel->awaiting_placement) {
+      /* Newly mapped windows are only shown once they are in place */
+      wlr_scene_node_set_position(&toplevel->scene_tree->node,
+                                  toplevel->tile.x, toplevel->tile.y);
+      spatial_update_toplevel(toplevel);
+      wlr_scene_node_set_enabled(&toplevel->scene_tree->node,
+                                 !toplevel->tab_hidden);
+      toplevel->awaiting_placement = false;
+      animation_fade_in(server, &toplevel->content_tree->node);
+    } else {
+      animation_move(toplevel, toplevel->tile.x, toplevel->tile.y);
+    }
+    toplevel_update_borders(toplevel);
+
+    wl_list_remove(&toplevel->txn_link);
+    toplevel->in_transaction = false;
+    toplevel->txn_serial = 0;
+  }
+
+  txn->num_waiting = 0;
+  txn->in_flight = false;
+  wl_event_source_timer_update(txn->timeout, 0);
+
+  occlusion_schedule(server);
+}
+
+static int transaction_handle_timeout(void *data) {
+  struct tinywl_server *server = data;
+  wlr_log(WLR_DEBUG, "Transaction timed out, %zu clients did not respond",
+          server->transaction->num_waiting);
+  transaction_apply(server);
+  return 0;
+}
+
+void transaction_init(struct tinywl_server *server) {
+  struct tinywl_transaction *txn = calloc(1, sizeof(*txn));
+  wl_list_init(&txn->toplevels);
+  txn->timeout =
+      wl_event_loop_add_timer(wl_display_get_event_loop(server->wl_display),
+                              transaction_handle_timeout, server);
+  server->transaction = txn;
+}
+
+void transaction_finish(struct tinywl_server *server) {
+  if (server->transaction == NULL) {
+    return;
+  }
+  wl_event_source_remove(server->transaction->timeout);
+  free(server->transaction);
+  server->transaction = NULL;
+}
+
+void transaction_add_toplevel(struct tinywl_toplevel *toplevel,
+                              uint32_t serial) {
+  struct tinywl_transaction *txn = toplevel->server->transaction;
+
+  if (!toplevel->in_transaction) {
+    wl_list_insert(txn->toplevels.prev, &toplevel->txn_link);
+    toplevel->in_transaction = true;
+  }
+  if (serial != 0) {
+    if (toplevel->txn_serial == 0) {
+      txn->num_waiting++;
+    }
+    toplevel->txn_serial = serial;
+  }
+}
+
+void transaction_remove_toplevel(struct tinywl_toplevel *toplevel) {
+  struct tinywl_server *server = toplevel->server;
+  struct tinywl_transaction *txn = server->transaction;
+  if (!toplevel->in_transaction) {
+    return;
+  }
+
+  wl_list_remove(&toplevel->txn_link);
+  toplevel->in_transaction = false;
+  if (toplevel->txn_serial != 0) {
+    toplevel->txn_serial = 0;
+    txn->num_waiting--;
+  }
+
+  /* The others may have only been waiting on this window */
+  if (txn->in_flight && txn->num_waiting == 0) {
+    transaction_apply(server);
+  }
+}
+
+void transaction_commit(struct tinywl_server *server) {
+  struct tinywl_transaction *txn = server->transaction;
+  if (txn->batch_depth > 0 || txn->in_flight ||
+      wl_list_empty(&txn->toplevels)) {
+    return;
+  }
+
+  if (txn->num_waiting == 0) {
+    transaction_apply(server);
+    return;
+  }
+
+  txn->in_flight = true;
+  wl_event_source_timer_update(txn->timeout, TRANSACTION_TIMEOUT_MS);
+}
+
+void transaction_begin_batch(struct tinywl_server *server) {
+  server->transaction->batch_depth++;
+}
+
+void transaction_end_batch(struct tinywl_server *server) {
+  if (--server->transaction->batch_depth == 0) {
+    transaction_commit(server);
+  }
+}
+
+void transaction_notify_commit(struct tinywl_toplevel *toplevel) {
+  if (toplevel->txn_serial == 0) {
+    return;
+  }
+
+  /* Serials wrap around, compare them as a signed difference */
+  uint32_t acked = toplevel->xdg_toplevel->base->current.configure_serial;
+  if ((int32_t)(acked - toplevel->txn_serial) < 0) {
+    return;
+  }
+
+  struct tinywl_server *server = toplevel->server;
+  struct tinywl_transaction *txn = server->transaction;
+  toplevel->txn_serial = 0;
+  txn->num_waiting--;
+  if (txn->in_flight && txn->num_waiting == 0) {
+    transaction_apply(server);
+  }
+}
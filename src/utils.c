@@ -1,8 +1,15 @@
 #include <signal.h>
+#include <time.h>
 #include <unistd.h>
 
+#include "layout.h"
+#include "occlusion.h"
+#include "output.h"
+#include "popup.h"
+#include "spatial.h"
 #include "toplevel.h"
 #include "utils.h"
+#include "workspace.h"
 
 /*
  * execute_program - Forks and executes a shell command
@@ -44,20 +51,29 @@ void focus_toplevel(struct tinywl_toplevel *toplevel) {
      * it no longer has focus and the client will repaint accordingly, e.g.
      * stop displaying a caret.
      */
+    struct tinywl_toplevel *prev = get_focused_toplevel(server);
     struct wlr_xdg_toplevel *prev_toplevel =
         wlr_xdg_toplevel_try_from_wlr_surface(prev_surface);
-    if (prev_toplevel != NULL) {
+    if (prev != NULL) {
+      /* Its menus go away with the focus, and their grab with them, or the
+       * keyboard couldn't enter the new surface */
+      popup_dismiss_all(prev);
+      toplevel_set_activated(prev, false);
+    } else if (prev_toplevel != NULL) {
       wlr_xdg_toplevel_set_activated(prev_toplevel, false);
     }
   }
 
   struct wlr_keyboard *keyboard = wlr_seat_get_keyboard(seat);
-  /* Move the toplevel to the front */
+  /* Bring its tab forward, then move the toplevel to the front */
+  layout_show_toplevel(toplevel);
   wlr_scene_node_raise_to_top(&toplevel->scene_tree->node);
+  spatial_raise_toplevel(toplevel);
+  occlusion_schedule(server);
   wl_list_remove(&toplevel->link);
   wl_list_insert(&server->toplevels, &toplevel->link);
   /* Activate the new surface */
-  wlr_xdg_toplevel_set_activated(toplevel->xdg_toplevel, true);
+  toplevel_set_activated(toplevel, true);
   /*
    * Tell the seat to have the keyboard enter this surface. wlroots will keep
    * track of this and automatically send key events to the appropriate
@@ -70,33 +86,26 @@ void focus_toplevel(struct tinywl_toplevel *toplevel) {
   }
 }
 
-struct tinywl_toplevel *desktop_toplevel_at(struct tinywl_server *server,
-                                                   double lx, double ly,
-                                                   struct wlr_surface **surface,
-                                                   double *sx, double *sy) {
-  /* This returns the topmost node in the scene at the given layout coords.
-   * We only care about surface nodes as we are specifically looking for a
-   * surface in the surface tree of a tinywl_toplevel. */
-  struct wlr_scene_node *node =
-      wlr_scene_node_at(&server->scene->tree.node, lx, ly, sx, sy);
-  if (node == NULL || node->type != WLR_SCENE_NODE_BUFFER) {
+struct tinywl_toplevel *get_focused_toplevel(struct tinywl_server *server) {
+  if (wl_list_empty(&server->toplevels)) {
     return NULL;
   }
-  struct wlr_scene_buffer *scene_buffer = wlr_scene_buffer_from_node(node);
-  struct wlr_scene_surface *scene_surface =
-      wlr_scene_surface_try_from_buffer(scene_buffer);
-  if (!scene_surface) {
+  struct tinywl_toplevel *toplevel =
+      wl_container_of(server->toplevels.next, toplevel, link);
+  if (toplevel->xdg_toplevel->base->surface !=
+      server->seat->keyboard_state.focused_surface) {
     return NULL;
   }
+  return toplevel;
+}
 
-  *surface = scene_surface->surface;
-  /* Find the node corresponding to the tinywl_toplevel at the root of this
-   * surface tree, it is the only one for which we set the data field. */
-  struct wlr_scene_tree *tree = node->parent;
-  while (tree != NULL && tree->node.data == NULL) {
-    tree = tree->node.parent;
-  }
-  return tree->node.data;
+struct tinywl_toplevel *desktop_toplevel_at(struct tinywl_server *server,
+                                                   double lx, double ly,
+                                                   struct wlr_surface **surface,
+                                                   double *sx, double *sy) {
+  /* The spatial index narrows the scene down to the few windows near the
+   * point, and only those are searched with wlr_scene_node_at() */
+  return spatial_toplevel_at(server, lx, ly, surface, sx, sy);
 }
 
 void close_focused_surface(struct tinywl_server *server) {
@@ -115,14 +124,28 @@ void close_focused_surface(struct tinywl_server *server) {
 }
 
 void cycle_toplevel(struct tinywl_server *server) {
-  if (wl_list_length(&server->toplevels) < 2) {
+  /* Checking for a second entry is constant time, unlike counting them */
+  if (wl_list_empty(&server->toplevels) ||
+      server->toplevels.next->next == &server->toplevels) {
     return;
   }
-  struct tinywl_toplevel *next_toplevel =
-      wl_container_of(server->toplevels.prev, next_toplevel, link);
-  focus_toplevel(next_toplevel);
+  /* Only cycle through windows on workspaces that are shown */
+  struct tinywl_toplevel *next_toplevel;
+  wl_list_for_each_reverse(next_toplevel, &server->toplevels, link) {
+    struct tinywl_workspace *workspace = next_toplevel->workspace;
+    if (workspace != NULL && workspace->output->active_workspace == workspace) {
+      focus_toplevel(next_toplevel);
+      return;
+    }
+  }
 }
 
 void terminate_display(struct tinywl_server *server) {
   wl_display_terminate(server->wl_display);
 }
+
+uint64_t monotonic_ns(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
@@ -0,0 +1,284 @@
+#include "animation.h"
+#include "config.h"
+#include "layout.h"
+#include "occlusion.h"
+#include "output.h"
+#include "popup.h"
+#include "spatial.h"
+#include "toplevel.h"
+#include "transaction.h"
+#include "utils.h"
+#include "workspace.h"
+
+void focus_workspace(struct tinywl_workspace *workspace) {
+  /* server->toplevels is in focus order, so the first window found is the
+   * one that was focused last on this workspace. */
+  struct tinywl_server *server = workspace->output->server;
+  struct tinywl_toplevel *toplevel;
+  wl_list_for_each(toplevel, &server->toplevels, link) {
+    if (toplevel->workspace == workspace) {
+      focus_toplevel(toplevel);
+      return;
+    }
+  }
+
+  /* Nothing to focus, make sure keys don't go to a window we can't see */
+  struct tinywl_toplevel *focused = get_focused_toplevel(server);
+  if (focused != NULL) {
+    popup_dismiss_all(focused);
+    toplevel_set_activated(focused, false);
+  }
+  wlr_seat_keyboard_notify_clear_focus(server->seat);
+}
+
+void workspace_init(struct tinywl_workspace *workspace,
+                    struct tinywl_output *output, int index) {
+  workspace->output = output;
+  workspace->index = index;
+  workspace->tree = wlr_scene_tree_create(&output->server->scene->tree);
+  wlr_scene_node_set_enabled(&workspace->tree->node, false);
+  /* Created last, so the floating layer is drawn on top */
+  workspace->tiled_tree = wlr_scene_tree_create(workspace->tree);
+  workspace->floating_tree = wlr_scene_tree_create(workspace->tree);
+  workspace->root = layout_root_create(workspace);
+}
+
+void workspace_finish(struct tinywl_workspace *workspace) {
+  layout_root_destroy(workspace->root);
+  spatial_grid_finish(&workspace->grid);
+  wlr_scene_node_destroy(&workspace->tree->node);
+}
+
+static void attach_toplevel(struct tinywl_workspace *workspace,
+                            struct tinywl_toplevel *toplevel,
+                            struct wlr_scene_tree *layer) {
+  toplevel->workspace = workspace;
+  wlr_scene_node_reparent(&toplevel->scene_tree->node, layer);
+  spatial_raise_toplevel(toplevel);
+  spatial_update_toplevel(toplevel);
+  occlusion_schedule(toplevel->server);
+}
+
+void workspace_add_toplevel(struct tinywl_workspace *workspace,
+                            struct tinywl_toplevel *toplevel, bool tile) {
+  attach_toplevel(workspace, toplevel,
+                  tile ? workspace->tiled_tree : workspace->floating_tree);
+  if (tile) {
+    layout_insert(workspace->root, toplevel);
+  }
+}
+
+void workspace_fill_placeholder(struct tinywl_workspace *workspace,
+                                struct tinywl_toplevel *toplevel,
+                                struct tinywl_container *placeholder) {
+  attach_toplevel(workspace, toplevel, workspace->tiled_tree);
+  layout_fill_placeholder(placeholder, toplevel);
+}
+
+void workspace_remove_toplevel(struct tinywl_toplevel *toplevel) {
+  if (toplevel->workspace == NULL) {
+    return;
+  }
+  animation_finish_node(toplevel->server, &toplevel->scene_tree->node);
+  layout_remove(toplevel);
+  spatial_remove_toplevel(toplevel);
+  wlr_scene_node_reparent(&toplevel->scene_tree->node,
+                          &toplevel->server->scene->tree);
+  toplevel->workspace = NULL;
+  occlusion_schedule(toplevel->server);
+}
+
+void workspace_move_toplevel(struct tinywl_toplevel *toplevel,
+                             struct tinywl_workspace *workspace) {
+  struct tinywl_workspace *from = toplevel->workspace;
+  if (from == workspace) {
+    return;
+  }
+
+  bool tile = toplevel->container != NULL;
+  if (!tile && from != NULL && from->output != workspace->output) {
+    /* Keep floating windows at the same place relative to the output */
+    struct tinywl_server *server = toplevel->server;
+    struct wlr_box from_box, to_box;
+    wlr_output_layout_get_box(server->output_layout, from->output->wlr_output,
+                              &from_box);
+    wlr_output_layout_get_box(server->output_layout,
+                              workspace->output->wlr_output, &to_box);
+    struct wlr_scene_node *node = &toplevel->scene_tree->node;
+    wlr_scene_node_set_position(node, node->x - from_box.x + to_box.x,
+                                node->y - from_box.y + to_box.y);
+    toplevel->floating_box.x += to_box.x - from_box.x;
+    toplevel->floating_box.y += to_box.y - from_box.y;
+  }
+
+  workspace_remove_toplevel(toplevel);
+  workspace_add_toplevel(workspace, toplevel, tile);
+
+  if (toplevel->maximized) {
+    /* Fit the window to the usable area of its new output */
+    toplevel_set_maximized(toplevel, true);
+    transaction_commit(toplevel->server);
+  }
+}
+
+void workspace_set_floating(struct tinywl_toplevel *toplevel, bool floating) {
+  struct tinywl_workspace *workspace = toplevel->workspace;
+  if (workspace == NULL || floating == (toplevel->container == NULL)) {
+    return;
+  }
+  struct wlr_xdg_toplevel *xdg_toplevel = toplevel->xdg_toplevel;
+  struct wlr_scene_node *node = &toplevel->scene_tree->node;
+
+  if (!floating) {
+    /* Remember where the window floated. A maximized window already saved
+     * the geometry it had before it was maximized. */
+    if (toplevel->maximized) {
+      toplevel->maximized = false;
+      wlr_xdg_toplevel_set_maximized(xdg_toplevel, false);
+    } else {
+      struct wlr_box *geo_box = &xdg_toplevel->base->geometry;
+      toplevel->floating_box = (struct wlr_box){
+          .x = node->x,
+          .y = node->y,
+          .width = geo_box->width,
+          .height = geo_box->height,
+      };
+    }
+
+    wlr_scene_node_reparent(node, workspace->tiled_tree);
+    spatial_raise_toplevel(toplevel);
+    wlr_xdg_toplevel_set_tiled(xdg_toplevel, WLR_EDGE_TOP | WLR_EDGE_BOTTOM |
+                                                 WLR_EDGE_LEFT |
+                                                 WLR_EDGE_RIGHT);
+    /* The tile has nothing to do with the floating geometry, make sure the
+     * layout sends the window its size */
+    toplevel->tile = (struct wlr_box){0};
+    layout_insert(workspace->root, toplevel);
+    return;
+  }
+
+  /* The window's tile no longer matters, don't let a pending transaction
+   * move it back into place */
+  transaction_remove_toplevel(toplevel);
+  layout_remove(toplevel);
+  wlr_scene_node_reparent(node, workspace->floating_tree);
+  spatial_raise_toplevel(toplevel);
+  wlr_xdg_toplevel_set_tiled(xdg_toplevel, WLR_EDGE_NONE);
+
+  if (wlr_box_empty(&toplevel->floating_box)) {
+    /* Never floated before, keep the current size and center it */
+    struct wlr_box *area = &workspace->output->usable_area;
+    struct wlr_box *geo_box = &xdg_toplevel->base->geometry;
+    toplevel->floating_box = (struct wlr_box){
+        .x = area->x + (area->width - geo_box->width) / 2,
+        .y = area->y + (area->height - geo_box->height) / 2,
+        .width = geo_box->width,
+        .height = geo_box->height,
+    };
+  }
+
+  struct wlr_box *box = &toplevel->floating_box;
+  uint32_t serial = 0;
+  if (box->width != toplevel->tile.width ||
+      box->height != toplevel->tile.height) {
+    serial = wlr_xdg_toplevel_set_size(xdg_toplevel, box->width, box->height);
+  }
+  toplevel->tile = *box;
+  transaction_add_toplevel(toplevel, serial);
+  transaction_commit(toplevel->server);
+}
+
+void toggle_floating_focused(struct tinywl_server *server) {
+  struct tinywl_toplevel *toplevel = get_focused_toplevel(server);
+  if (toplevel != NULL) {
+    /* A tiled window is no longer a scratchpad window, see scratchpad.h */
+    bool tile = toplevel->container == NULL;
+    if (tile) {
+      toplevel->scratchpad = false;
+    }
+    workspace_set_floating(toplevel, !tile);
+  }
+}
+
+static struct tinywl_container *
+container_root(struct tinywl_container *container) {
+  while (container->parent != NULL) {
+    container = container->parent;
+  }
+  return container;
+}
+
+void workspace_restore_layout(struct tinywl_workspace *workspace,
+                              struct tinywl_container *saved) {
+  struct tinywl_server *server = workspace->output->server;
+  struct tinywl_toplevel *toplevel;
+  wl_list_for_each(toplevel, &server->toplevels, link) {
+    if (toplevel->home_leaf == NULL ||
+        container_root(toplevel->home_leaf) != saved) {
+      continue;
+    }
+    if (toplevel->hidden ||
+        (toplevel->workspace != NULL && toplevel->container == NULL)) {
+      /* Hidden or made floating since, it doesn't get its tile back */
+      layout_forget_leaf(toplevel);
+    } else {
+      workspace_remove_toplevel(toplevel);
+    }
+  }
+
+  layout_restore(workspace->root, saved);
+
+  /* The windows that got a leaf back are still off any workspace */
+  wl_list_for_each(toplevel, &server->toplevels, link) {
+    if (toplevel->workspace == NULL && toplevel->container != NULL) {
+      attach_toplevel(workspace, toplevel, workspace->tiled_tree);
+    }
+  }
+}
+
+void workspace_show(struct tinywl_workspace *workspace) {
+  struct tinywl_output *output = workspace->output;
+  if (output->active_workspace == workspace) {
+    return;
+  }
+
+  if (output->active_workspace != NULL) {
+    wlr_scene_node_set_enabled(&output->active_workspace->tree->node, false);
+  }
+  wlr_scene_node_set_enabled(&workspace->tree->node, true);
+  output->active_workspace = workspace;
+  animation_fade_in(output->server, &workspace->tree->node);
+  occlusion_schedule(output->server);
+
+  focus_workspace(workspace);
+}
+
+void switch_workspace(struct tinywl_server *server, int index) {
+  struct tinywl_output *output =
+      output_at(server, server->cursor->x, server->cursor->y);
+  if (output == NULL || index < 0 || index >= WORKSPACE_COUNT) {
+    return;
+  }
+  workspace_show(&output->workspaces[index]);
+}
+
+void move_focused_to_workspace(struct tinywl_server *server, int index) {
+  struct tinywl_toplevel *toplevel = get_focused_toplevel(server);
+  if (toplevel == NULL || toplevel->workspace == NULL || index < 0 ||
+      index >= WORKSPACE_COUNT) {
+    return;
+  }
+
+  struct tinywl_workspace *from = toplevel->workspace;
+  struct tinywl_workspace *to = &from->output->workspaces[index];
+  if (from == to) {
+    return;
+  }
+
+  /* Moved on purpose, it stays there if its old output comes back */
+  output_forget_toplevel(toplevel);
+  workspace_move_toplevel(toplevel, to);
+
+  /* The focused window just left, focus the next one on this workspace */
+  focus_workspace(from);
+}